@@ -1,30 +1,105 @@
 #include "core/event.h"
 #include "core/fmemory.h"
-#include "helpers/dinoarray.h"
+#include "helpers/ringbuffer.h"
 #include "core/logger.h"
 
+#if EVENT_STATS_ENABLED == 1
+#include "platform/platform.h"
+#endif
+
+#include <stdatomic.h>
+
+#define EVENT_CODE_COUNT (MAX_EVENT_CODE + 1)
+
 typedef struct registeredEvent {
-    void* listener;
+    // 0 once unregistered, until the next compaction drops it.
     PF_on_event functionCallback;
+    void* listener;
+    i16 priority;
+    u16 code;
+    // Owning handle's slot, to keep it pointing here when this moves.
+    u16 slot;
 } registeredEvent;
 
+// A code's run of listeners, dead ones included. first is valid for codes
+// without listeners too, it is where theirs would go.
 typedef struct eventCodeEntry {
-    registeredEvent* events;
+    u16 first;
+    u16 count;
 } eventCodeEntry;
 
-// This should be more than enough codes...
-#define MAX_MESSAGE_CODES 16384
+typedef struct listenerSlot {
+    u16 index;
+    // Bumped on unregister so old handles stop matching.
+    u16 generation;
+} listenerSlot;
+
+typedef struct queuedEvent {
+    void* sender;
+    eventContext context;
+    u16 code;
+} queuedEvent;
+
+typedef struct eventQueue {
+    queuedEvent events[EVENT_QUEUE_CAPACITY];
+    u32 count;
+} eventQueue;
 
 // State structure.
 // List of registered events
 typedef struct eventSystemState {
     // Lookup table for event codes.
-    eventCodeEntry registered[MAX_MESSAGE_CODES];
+    eventCodeEntry registered[EVENT_CODE_COUNT];
+
+    // Every code's listeners, sorted by code then priority. Registrations
+    // made while listeners run are appended behind listenerCount and merged
+    // in once nothing is firing, so runs never move under a fire.
+    registeredEvent listeners[EVENT_MAX_LISTENERS];
+    u16 listenerCount;
+    u16 addedCount;
+    u16 deadCount;
+    // Nesting depth of eventFire/dispatch.
+    u16 firing;
+
+    listenerSlot slots[EVENT_MAX_LISTENERS];
+    u16 freeSlots[EVENT_MAX_LISTENERS];
+    u16 freeSlotCount;
+
+    // eventPost appends to queues[postIdx]. Dispatch flips postIdx first so
+    // anything posted by a listener waits for the next dispatch.
+    eventQueue queues[2];
+    u32 postIdx;
+    b8 dispatching;
+
+    // eventCoalescing per code and where the code's latest event sits in the
+    // post queue (+1, 0 means none queued).
+    u8 coalescing[EVENT_CODE_COUNT];
+    u16 pending[EVENT_CODE_COUNT];
+
+    // Events posted from other threads, moved into the post queue at the
+    // start of each dispatch.
+    mpmcRing remote;
+    _Atomic u32 remoteDropped;
+
+#if EVENT_STATS_ENABLED == 1
+    eventCodeStats codeStats[EVENT_CODE_COUNT];
+    // By listener slot, those don't move.
+    eventListenerStats listenerStats[EVENT_MAX_LISTENERS];
+    f64 statsWindowStart;
+#endif
+
+    // Dispatch scratch. Events grouped by code, the codes in the order they
+    // were first posted and the per code counts/offsets.
+    queuedEvent grouped[EVENT_QUEUE_CAPACITY];
+    u16 groupCodes[EVENT_QUEUE_CAPACITY];
+    u16 groupOffsets[EVENT_CODE_COUNT];
 } eventSystemState;
 
 
-static b8 isInit = false;
+static _Atomic b8 isInit = false;
 static eventSystemState* systemPtr;
+// Set on the thread that called eventInit, the only one running listeners.
+static FSN_THREAD_LOCAL b8 isOwnerThread;
 
 b8 eventInit(u64* memoryRequirement, void* state) {
     *memoryRequirement = sizeof(eventSystemState);
@@ -32,91 +107,565 @@ b8 eventInit(u64* memoryRequirement, void* state) {
         return true;
     }
     systemPtr = state;
+    fzeroMemory(systemPtr, sizeof(eventSystemState));
+    if(!mpmcRingCreate(sizeof(queuedEvent), EVENT_REMOTE_QUEUE_CAPACITY, &systemPtr->remote)) {
+        FERROR("Failed to create the event system's remote queue");
+        return false;
+    }
+    for(u16 i = 0; i < EVENT_MAX_LISTENERS; ++i) {
+        systemPtr->slots[i].generation = 1;
+        systemPtr->freeSlots[i] = EVENT_MAX_LISTENERS - 1 - i;
+    }
+    systemPtr->freeSlotCount = EVENT_MAX_LISTENERS;
+#if EVENT_STATS_ENABLED == 1
+    systemPtr->statsWindowStart = platformGetAbsoluteTime();
+#endif
+    isOwnerThread = true;
     isInit = true;
+
+    // Only the latest position/size matters, a wheel is the sum of its
+    // steps and a held key repeating within one frame says nothing new.
+    eventSetCoalescing(EVENT_CODE_MOUSE_MOVED, EVENT_COALESCE_KEEP_LATEST);
+    eventSetCoalescing(EVENT_CODE_RESIZED, EVENT_COALESCE_KEEP_LATEST);
+    eventSetCoalescing(EVENT_CODE_MOUSE_WHEEL, EVENT_COALESCE_ACCUMULATE_I8);
+    eventSetCoalescing(EVENT_CODE_KEY_DOWN, EVENT_COALESCE_DROP_DUPLICATE);
+    eventSetCoalescing(EVENT_CODE_BUTTON_DOWN, EVENT_COALESCE_DROP_DUPLICATE);
     return true;
 }
 
+void eventSetCoalescing(u16 code, eventCoalescing policy) {
+    if(isInit == false || code > MAX_EVENT_CODE) {
+        return;
+    }
+    systemPtr->coalescing[code] = policy;
+}
+
 void eventShutdown() {
-    // Free the events arrays. And objects pointed to should be destroyed on their own.
-    for(u16 i = 0; i < MAX_MESSAGE_CODES; ++i){
-        if(systemPtr->registered[i].events != 0) {
-            dinoDestroy(systemPtr->registered[i].events);
-            systemPtr->registered[i].events = 0;
+    isInit = false;
+    mpmcRingDestroy(&systemPtr->remote);
+    // Listeners live in the state itself, nothing else to free.
+}
+
+// Slides listeners[at, listenerCount) up by one and inserts e at at.
+static void insertAt(u16 at, registeredEvent e) {
+    registeredEvent* listeners = systemPtr->listeners;
+    for(u16 i = systemPtr->listenerCount; i > at; --i) {
+        listeners[i] = listeners[i - 1];
+        if(listeners[i].functionCallback) {
+            systemPtr->slots[listeners[i].slot].index = i;
         }
     }
+    listeners[at] = e;
+    systemPtr->slots[e.slot].index = at;
+    systemPtr->listenerCount++;
+
+    systemPtr->registered[e.code].count++;
+    for(u32 c = e.code + 1; c < EVENT_CODE_COUNT; ++c) {
+        systemPtr->registered[c].first++;
+    }
 }
 
-b8 eventRegister(u16 code, void* listener, PF_on_event on_event) {
-    if(isInit == false) {
-        return false;
+// Puts e behind the code's listeners with a priority >= its own.
+static void insertSorted(registeredEvent e) {
+    eventCodeEntry entry = systemPtr->registered[e.code];
+    u16 at = entry.first;
+    while(at < entry.first + entry.count && systemPtr->listeners[at].priority >= e.priority) {
+        at++;
+    }
+    insertAt(at, e);
+}
+
+// Drops dead listeners and rebuilds the code runs.
+static void compact() {
+    registeredEvent* listeners = systemPtr->listeners;
+    eventCodeEntry* codes = systemPtr->registered;
+    for(u32 c = 0; c < EVENT_CODE_COUNT; ++c) {
+        codes[c].count = 0;
     }
+    // The added ones behind listenerCount move down with the rest.
+    u16 total = systemPtr->listenerCount + systemPtr->addedCount;
+    u16 kept = 0;
+    u16 keptSorted = 0;
+    for(u16 i = 0; i < total; ++i) {
+        if(!listeners[i].functionCallback) {
+            continue;
+        }
+        listeners[kept] = listeners[i];
+        systemPtr->slots[listeners[kept].slot].index = kept;
+        if(i < systemPtr->listenerCount) {
+            codes[listeners[kept].code].count++;
+            keptSorted++;
+        }
+        kept++;
+    }
+    u16 first = 0;
+    for(u32 c = 0; c < EVENT_CODE_COUNT; ++c) {
+        codes[c].first = first;
+        first += codes[c].count;
+    }
+    systemPtr->listenerCount = keptSorted;
+    systemPtr->addedCount = kept - keptSorted;
+    systemPtr->deadCount = 0;
+}
 
-    if(systemPtr->registered[code].events == 0) {
-        systemPtr->registered[code].events = dinoCreate(registeredEvent);
+// Once nothing is firing: compacts and merges the listeners registered
+// while something was.
+static void settle() {
+    if(systemPtr->deadCount) {
+        compact();
     }
+    while(systemPtr->addedCount) {
+        // insertAt overwrites this slot, so take a copy first.
+        registeredEvent e = systemPtr->listeners[systemPtr->listenerCount];
+        systemPtr->addedCount--;
+        insertSorted(e);
+    }
+}
 
-    u64 registered_count = dinoLength(systemPtr->registered[code].events);
-    for(u64 i = 0; i < registered_count; ++i) {
-        if(systemPtr->registered[code].events[i].listener == listener) {
-            FWARN("Event listener already added.");
-            return false;
+// Looks through the code's run and the listeners added while firing.
+static b8 findListener(u16 code, void* listener, PF_on_event onEvent, u16* outIndex) {
+    eventCodeEntry entry = systemPtr->registered[code];
+    u16 ranges[2][2] = {
+        {entry.first, entry.first + entry.count},
+        {systemPtr->listenerCount, systemPtr->listenerCount + systemPtr->addedCount}};
+    for(u32 r = 0; r < 2; ++r) {
+        for(u16 i = ranges[r][0]; i < ranges[r][1]; ++i) {
+            registeredEvent* e = &systemPtr->listeners[i];
+            if(e->code == code && e->listener == listener && e->functionCallback == onEvent) {
+                *outIndex = i;
+                return true;
+            }
         }
     }
+    return false;
+}
+
+b8 eventRegisterHandle(u16 code, void* listener, PF_on_event onEvent, i16 priority, eventHandle* outHandle) {
+    if(outHandle) {
+        *outHandle = EVENT_HANDLE_INVALID;
+    }
+    if(isInit == false || code > MAX_EVENT_CODE || onEvent == 0) {
+        return false;
+    }
+
+    u16 existing;
+    if(findListener(code, listener, onEvent, &existing)) {
+        FWARN("Event listener already added.");
+        return false;
+    }
+    if(!systemPtr->firing &&
+       systemPtr->listenerCount + systemPtr->addedCount == EVENT_MAX_LISTENERS) {
+        // Unregistering between fires only marks entries dead, make room
+        // from those before giving up
+        settle();
+    }
+    if(systemPtr->freeSlotCount == 0 ||
+       systemPtr->listenerCount + systemPtr->addedCount == EVENT_MAX_LISTENERS) {
+        FERROR("Out of event listeners, raise EVENT_MAX_LISTENERS.");
+        return false;
+    }
 
     // If at this point, no duplicate was found. Proceed with registration.
     registeredEvent event;
+    event.functionCallback = onEvent;
     event.listener = listener;
-    event.functionCallback = on_event;
-    dinoPush(systemPtr->registered[code].events, event);
+    event.priority = priority;
+    event.code = code;
+    event.slot = systemPtr->freeSlots[--systemPtr->freeSlotCount];
+#if EVENT_STATS_ENABLED == 1
+    fzeroMemory(&systemPtr->listenerStats[event.slot], sizeof(eventListenerStats));
+#endif
 
+    if(systemPtr->firing) {
+        u16 at = systemPtr->listenerCount + systemPtr->addedCount++;
+        systemPtr->listeners[at] = event;
+        systemPtr->slots[event.slot].index = at;
+    } else {
+        insertSorted(event);
+    }
+
+    if(outHandle) {
+        *outHandle = ((eventHandle)systemPtr->slots[event.slot].generation << 16) | event.slot;
+    }
     return true;
 }
 
-b8 eventUnregister(u16 code, void* listener, PF_on_event onEvent) {
+b8 eventRegister(u16 code, void* listener, PF_on_event on_event) {
+    return eventRegisterHandle(code, listener, on_event, EVENT_PRIORITY_DEFAULT, 0);
+}
+
+// Kills listeners[index] and frees its slot. The entry itself stays until the
+// next compaction so fires walking over it are left alone.
+static void removeAt(u16 index) {
+    registeredEvent* e = &systemPtr->listeners[index];
+    listenerSlot* slot = &systemPtr->slots[e->slot];
+    slot->generation = slot->generation == 0xFFFF ? 1 : slot->generation + 1;
+    systemPtr->freeSlots[systemPtr->freeSlotCount++] = e->slot;
+    e->functionCallback = 0;
+    systemPtr->deadCount++;
+}
+
+b8 eventUnregisterHandle(eventHandle handle) {
     if(isInit == false) {
         return false;
     }
+    u16 slot = handle & 0xFFFF;
+    u16 generation = handle >> 16;
+    if(slot >= EVENT_MAX_LISTENERS || generation == 0 ||
+       systemPtr->slots[slot].generation != generation) {
+        return false;
+    }
+    removeAt(systemPtr->slots[slot].index);
+    return true;
+}
+
+b8 eventUnregister(u16 code, void* listener, PF_on_event onEvent) {
+    if(isInit == false || code > MAX_EVENT_CODE || onEvent == 0) {
+        return false;
+    }
 
-    // On nothing is registered for the code, return out.
-    if(systemPtr->registered[code].events == 0) {
-        FWARN("Event code has no listeners registered.");
+    u16 index;
+    if(!findListener(code, listener, onEvent, &index)) {
+        // Not found.
         return false;
     }
-    u64 registered_count = dinoLength(systemPtr->registered[code].events);
-    for(u64 i = 0; i < registered_count; ++i) {
-        registeredEvent e = systemPtr->registered[code].events[i];
-        if(e.listener == listener && e.functionCallback == onEvent) {
-            // Found one, remove it
-            registeredEvent popped_event;
-            dinoPopAt(systemPtr->registered[code].events, i, &popped_event);
+    removeAt(index);
+    return true;
+}
+
+#if EVENT_STATS_ENABLED == 1
+static void statsRecordCall(const registeredEvent* e, u16 code, f64 time, b8 handled) {
+    // Listeners that unregistered themselves may have had their slot taken
+    // already.
+    if(!e->functionCallback) {
+        return;
+    }
+    eventListenerStats* stats = &systemPtr->listenerStats[e->slot];
+    stats->calls++;
+    stats->handled += handled;
+    stats->totalTime += time;
+    if(time > stats->maxTime) {
+        stats->maxTime = time;
+    }
+    if(time > EVENT_STATS_SLOW_LISTENER) {
+        FWARN_LIMITED(1, "Slow event listener %p (listener %p) took %.3fms for code %u.",
+                      (void*)e->functionCallback, e->listener, time * 1000.0, code);
+    }
+}
+#endif
 
+// Runs one event through a code's listeners. Nothing moves while firing is
+// non zero, so the run can be read once.
+FSN_INLINE b8 fireRun(const registeredEvent* run, u16 count, u16 code, void* sender, eventContext context) {
+#if EVENT_STATS_ENABLED == 1
+    systemPtr->codeStats[code].fired++;
+#endif
+    for(u16 i = 0; i < count; ++i) {
+        PF_on_event callback = run[i].functionCallback;
+        if(!callback) {
+            continue;
+        }
+#if EVENT_STATS_ENABLED == 1
+        f64 start = platformGetAbsoluteTime();
+        b8 handled = callback(code, sender, run[i].listener, context);
+        statsRecordCall(&run[i], code, platformGetAbsoluteTime() - start, handled);
+#else
+        b8 handled = callback(code, sender, run[i].listener, context);
+#endif
+        if(handled) {
+            // Message has been handled, do not send to other listeners.
+#if EVENT_STATS_ENABLED == 1
+            systemPtr->codeStats[code].handled++;
+#endif
             return true;
         }
     }
-
-    // Not found.
     return false;
 }
 
 b8 eventFire(u16 code, void* sender, eventContext context) {
-    if(isInit == false) {
+    if(isInit == false || code > MAX_EVENT_CODE) {
         return false;
     }
 
+    eventCodeEntry entry = systemPtr->registered[code];
     // If nothing is registered for the code, boot out.
-    if(systemPtr->registered[code].events == 0) {
+    if(entry.count == 0) {
         return false;
     }
 
-    u64 registered_count = dinoLength(systemPtr->registered[code].events);
-    for(u64 i = 0; i < registered_count; ++i) {
-        registeredEvent e = systemPtr->registered[code].events[i];
-        if(e.functionCallback(code, sender, e.listener, context)) {
-            // Message has been handled, do not send to other listeners.
+    systemPtr->firing++;
+    b8 handled = fireRun(&systemPtr->listeners[entry.first], entry.count, code, sender, context);
+    if(--systemPtr->firing == 0 && systemPtr->addedCount) {
+        settle();
+    }
+    return handled;
+}
+
+FSN_INLINE i32 clampAdd(i32 a, i32 b, i32 min, i32 max) {
+    i32 sum = a + b;
+    return sum < min ? min : (sum > max ? max : sum);
+}
+
+// Folds context into the already queued event of the same code. Returns false
+// if the policy says both have to be kept.
+static b8 coalesce(u8 policy, queuedEvent* queued, void* sender, eventContext context) {
+    if(queued->sender != sender) {
+        return false;
+    }
+    eventContext* q = &queued->context;
+    switch(policy) {
+        case EVENT_COALESCE_KEEP_LATEST:
+            *q = context;
+            return true;
+        case EVENT_COALESCE_DROP_DUPLICATE:
+            return q->data.u64[0] == context.data.u64[0] && q->data.u64[1] == context.data.u64[1];
+        case EVENT_COALESCE_ACCUMULATE_I8:
+            for(u32 i = 0; i < 16; ++i) {
+                q->data.i8[i] = clampAdd(q->data.i8[i], context.data.i8[i], -128, 127);
+            }
             return true;
+        case EVENT_COALESCE_ACCUMULATE_I16:
+            for(u32 i = 0; i < 8; ++i) {
+                q->data.i16[i] = clampAdd(q->data.i16[i], context.data.i16[i], -32768, 32767);
+            }
+            return true;
+        case EVENT_COALESCE_ACCUMULATE_I32:
+            for(u32 i = 0; i < 4; ++i) {
+                q->data.i32[i] += context.data.i32[i];
+            }
+            return true;
+        case EVENT_COALESCE_ACCUMULATE_F32:
+            for(u32 i = 0; i < 4; ++i) {
+                q->data.f32[i] += context.data.f32[i];
+            }
+            return true;
+        default:
+            return false;
+    }
+}
+
+static b8 postLocal(u16 code, void* sender, eventContext context) {
+    eventQueue* queue = &systemPtr->queues[systemPtr->postIdx];
+    u8 policy = systemPtr->coalescing[code];
+    u16 pending = systemPtr->pending[code];
+    if(policy != EVENT_COALESCE_NONE && pending &&
+       coalesce(policy, &queue->events[pending - 1], sender, context)) {
+        return true;
+    }
+    if(queue->count == EVENT_QUEUE_CAPACITY) {
+        // Better late than lost, hand it out right away.
+        FWARN_LIMITED(1, "Event queue is full, firing event %u immediately.", code);
+        eventFire(code, sender, context);
+        return false;
+    }
+
+    queuedEvent* e = &queue->events[queue->count++];
+    e->sender = sender;
+    e->context = context;
+    e->code = code;
+    systemPtr->pending[code] = queue->count;
+    return true;
+}
+
+b8 eventPost(u16 code, void* sender, eventContext context) {
+    if(isInit == false || code > MAX_EVENT_CODE) {
+        return false;
+    }
+    if(isOwnerThread) {
+        return postLocal(code, sender, context);
+    }
+
+    queuedEvent e;
+    e.sender = sender;
+    e.context = context;
+    e.code = code;
+    if(!mpmcRingPush(&systemPtr->remote, &e)) {
+        // Listeners can't run here, all we can do is count it.
+        atomic_fetch_add_explicit(&systemPtr->remoteDropped, 1, memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+// Hands every event of one code to that code's listeners.
+static void dispatchGroup(u16 code, const queuedEvent* events, u32 count) {
+    eventCodeEntry entry = systemPtr->registered[code];
+    if(entry.count == 0) {
+        return;
+    }
+    const registeredEvent* run = &systemPtr->listeners[entry.first];
+    for(u32 i = 0; i < count; ++i) {
+        fireRun(run, entry.count, code, events[i].sender, events[i].context);
+    }
+}
+
+void eventDispatchQueued() {
+    if(isInit == false || systemPtr->dispatching) {
+        return;
+    }
+
+    // Other threads' events join in behind what this thread posted, and
+    // get coalesced like they were posted here.
+    queuedEvent remote;
+    while(mpmcRingPop(&systemPtr->remote, &remote)) {
+        postLocal(remote.code, remote.sender, remote.context);
+    }
+    u32 dropped = atomic_exchange_explicit(&systemPtr->remoteDropped, 0, memory_order_relaxed);
+    if(dropped) {
+        FWARN("Dropped %u events posted from other threads, the remote queue was full.", dropped);
+    }
+
+    eventQueue* queue = &systemPtr->queues[systemPtr->postIdx];
+    systemPtr->postIdx ^= 1;
+    if(queue->count == 0) {
+        if(systemPtr->firing == 0) {
+            settle();
         }
+        return;
     }
+    systemPtr->dispatching = true;
+    systemPtr->firing++;
 
-    // Not found.
+    // Counting sort by code. Events of a code keep their order, codes are
+    // dispatched in the order they were first posted.
+    u16* offsets = systemPtr->groupOffsets;
+    u16* codes = systemPtr->groupCodes;
+    u32 codeCount = 0;
+    for(u32 i = 0; i < queue->count; ++i) {
+        u16 code = queue->events[i].code;
+        // Nothing of this queue is left to coalesce with.
+        systemPtr->pending[code] = 0;
+        if(offsets[code]++ == 0) {
+            codes[codeCount++] = code;
+        }
+    }
+    u16 offset = 0;
+    for(u32 i = 0; i < codeCount; ++i) {
+        u16 count = offsets[codes[i]];
+        offsets[codes[i]] = offset;
+        offset += count;
+    }
+    for(u32 i = 0; i < queue->count; ++i) {
+        systemPtr->grouped[offsets[queue->events[i].code]++] = queue->events[i];
+    }
+    queue->count = 0;
+
+    // offsets now hold where each group ends, reset them for the next dispatch
+    // on the way.
+    u16 start = 0;
+    for(u32 i = 0; i < codeCount; ++i) {
+        u16 end = offsets[codes[i]];
+        offsets[codes[i]] = 0;
+        dispatchGroup(codes[i], &systemPtr->grouped[start], end - start);
+        start = end;
+    }
+
+    systemPtr->dispatching = false;
+    // Dead listeners are only swept here, keeping unregister O(1).
+    if(--systemPtr->firing == 0) {
+        settle();
+    }
+
+#if EVENT_STATS_ENABLED == 1
+    if(platformGetAbsoluteTime() - systemPtr->statsWindowStart >= EVENT_STATS_LOG_INTERVAL) {
+        eventStatsLogSummary();
+    }
+#endif
+}
+
+#if EVENT_STATS_ENABLED == 1
+#define EVENT_STATS_TOP 5
+
+// Keeps top[] holding the indices of the highest values seen, biggest first.
+static void keepTop(u32* top, f64* topValues, u32* topCount, u32 index, f64 value) {
+    if(value <= 0 || (*topCount == EVENT_STATS_TOP && value <= topValues[EVENT_STATS_TOP - 1])) {
+        return;
+    }
+    u32 at = *topCount < EVENT_STATS_TOP ? (*topCount)++ : EVENT_STATS_TOP - 1;
+    while(at > 0 && topValues[at - 1] < value) {
+        top[at] = top[at - 1];
+        topValues[at] = topValues[at - 1];
+        at--;
+    }
+    top[at] = index;
+    topValues[at] = value;
+}
+#endif
+
+b8 eventStatsGetCode(u16 code, eventCodeStats* outStats) {
+#if EVENT_STATS_ENABLED == 1
+    if(isInit == false || code > MAX_EVENT_CODE) {
+        return false;
+    }
+    *outStats = systemPtr->codeStats[code];
+    return true;
+#else
+    return false;
+#endif
+}
+
+b8 eventStatsGetListener(eventHandle handle, eventListenerStats* outStats) {
+#if EVENT_STATS_ENABLED == 1
+    u16 slot = handle & 0xFFFF;
+    if(isInit == false || slot >= EVENT_MAX_LISTENERS || handle >> 16 == 0 ||
+       systemPtr->slots[slot].generation != handle >> 16) {
+        return false;
+    }
+    *outStats = systemPtr->listenerStats[slot];
+    return true;
+#else
     return false;
+#endif
+}
+
+void eventStatsLogSummary() {
+#if EVENT_STATS_ENABLED == 1
+    if(isInit == false) {
+        return;
+    }
+    f64 window = platformGetAbsoluteTime() - systemPtr->statsWindowStart;
+
+    u32 top[EVENT_STATS_TOP];
+    f64 topValues[EVENT_STATS_TOP];
+    u32 topCount = 0;
+    for(u32 c = 0; c < EVENT_CODE_COUNT; ++c) {
+        keepTop(top, topValues, &topCount, c, (f64)systemPtr->codeStats[c].fired);
+    }
+    FDEBUG("Event stats over %.1fs, busiest codes:", window);
+    for(u32 i = 0; i < topCount; ++i) {
+        eventCodeStats* s = &systemPtr->codeStats[top[i]];
+        FDEBUG("  code %3u: %llu fired, %.1f%% handled", top[i], s->fired,
+               100.0 * s->handled / s->fired);
+    }
+
+    topCount = 0;
+    for(u32 i = 0; i < systemPtr->listenerCount; ++i) {
+        const registeredEvent* e = &systemPtr->listeners[i];
+        if(e->functionCallback) {
+            keepTop(top, topValues, &topCount, i, systemPtr->listenerStats[e->slot].totalTime);
+        }
+    }
+    FDEBUG("Slowest listeners:");
+    for(u32 i = 0; i < topCount; ++i) {
+        const registeredEvent* e = &systemPtr->listeners[top[i]];
+        eventListenerStats* s = &systemPtr->listenerStats[e->slot];
+        FDEBUG("  %p (listener %p) code %3u: %llu calls, %.3fms total, %.1fus avg, %.3fms max, %.1f%% handled",
+               (void*)e->functionCallback, e->listener, e->code, s->calls, s->totalTime * 1000.0,
+               s->totalTime * 1000000.0 / s->calls, s->maxTime * 1000.0, 100.0 * s->handled / s->calls);
+    }
+
+    eventStatsReset();
+#endif
+}
+
+void eventStatsReset() {
+#if EVENT_STATS_ENABLED == 1
+    if(isInit == false) {
+        return;
+    }
+    fzeroMemory(systemPtr->codeStats, sizeof(systemPtr->codeStats));
+    fzeroMemory(systemPtr->listenerStats, sizeof(systemPtr->listenerStats));
+    systemPtr->statsWindowStart = platformGetAbsoluteTime();
+#endif
 }
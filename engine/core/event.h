@@ -2,6 +2,22 @@
 
 #include "defines.h"
 
+// Count fires per code and time every listener call, see eventStatsLogSummary.
+// Off by default, the fire path is untouched then.
+#ifndef EVENT_STATS_ENABLED
+#define EVENT_STATS_ENABLED 0
+#endif
+
+// Seconds between the summaries logged from eventDispatchQueued.
+#ifndef EVENT_STATS_LOG_INTERVAL
+#define EVENT_STATS_LOG_INTERVAL 10.0
+#endif
+
+// A single listener call taking longer than this (seconds) gets a warning.
+#ifndef EVENT_STATS_SLOW_LISTENER
+#define EVENT_STATS_SLOW_LISTENER 0.002
+#endif
+
 typedef struct eventContext {
     // 128 bytes
     union {
@@ -46,6 +62,65 @@ typedef struct eventContext {
  */
 typedef b8 (*PF_on_event)(u16 eventCode, void* sender, void* listenerInstance, eventContext data);
 
+// Max amount of events eventPost can hold between two dispatches. Past that
+// events are fired right away.
+#define EVENT_QUEUE_CAPACITY 2048
+// Max amount of events other threads can have waiting for the next dispatch.
+// Past that their posts are dropped.
+#define EVENT_REMOTE_QUEUE_CAPACITY 1024
+// Max amount of listeners over all codes.
+#define EVENT_MAX_LISTENERS 1024
+
+// Listeners with a higher priority are called first, equal ones in the order
+// they registered.
+#define EVENT_PRIORITY_DEFAULT 0
+
+/** @brief Identifies one registration, see eventRegisterHandle. 0 is never valid. */
+typedef u32 eventHandle;
+#define EVENT_HANDLE_INVALID 0
+
+/** @brief Per code counters since the last summary/reset. */
+typedef struct eventCodeStats {
+    /** @brief Events run through the code's listeners, queued ones included. */
+    u64 fired;
+    /** @brief How many of them a listener returned true for. */
+    u64 handled;
+} eventCodeStats;
+
+/** @brief Per listener counters since the last summary/reset. */
+typedef struct eventListenerStats {
+    u64 calls;
+    u64 handled;
+    /** @brief Seconds spent in the listener. */
+    f64 totalTime;
+    /** @brief Seconds taken by the slowest call. */
+    f64 maxTime;
+} eventListenerStats;
+
+/**
+ * @brief What eventPost does with an event whose code already has one
+ * waiting in the queue from the same sender.
+ */
+typedef enum eventCoalescing {
+    /** @brief Keep both. */
+    EVENT_COALESCE_NONE = 0,
+    /** @brief The queued event takes the new context. */
+    EVENT_COALESCE_KEEP_LATEST,
+    /** @brief Drop the new event if its context is the same. */
+    EVENT_COALESCE_DROP_DUPLICATE,
+    /** @brief Add the new context's lanes onto the queued one, saturating. */
+    EVENT_COALESCE_ACCUMULATE_I8,
+    EVENT_COALESCE_ACCUMULATE_I16,
+    /** @brief Add the new context's lanes onto the queued one, wrapping. */
+    EVENT_COALESCE_ACCUMULATE_I32,
+    EVENT_COALESCE_ACCUMULATE_F32
+} eventCoalescing;
+
+/**
+ * The calling thread becomes the event system's owner. Registering,
+ * unregistering, firing and dispatching only happen on it, eventPost is the
+ * one way in for other threads.
+ */
 b8 eventInit(u64* memoryRequirement, void* state);
 void eventShutdown();
 
@@ -59,6 +134,19 @@ void eventShutdown();
  */
 CT_API b8 eventRegister(u16 code, void* listener, PF_on_event on_event);
 
+/**
+ * Like eventRegister, with a priority and a handle to unregister with in O(1).
+ * Listeners registered while events are being fired start receiving them
+ * once that is done.
+ * @param code The event code to listen for. Up to MAX_EVENT_CODE.
+ * @param listener A pointer to a listener instance. Can be 0/NULL.
+ * @param onEvent The callback function pointer to be invoked when the event code is fired.
+ * @param priority Higher goes first, see EVENT_PRIORITY_DEFAULT.
+ * @param outHandle Receives the registration's handle. Can be 0/NULL.
+ * @returns true if the event is successfully registered; otherwise false.
+ */
+CT_API b8 eventRegisterHandle(u16 code, void* listener, PF_on_event onEvent, i16 priority, eventHandle* outHandle);
+
 /**
  * Unregister from listening for when events are sent with the provided code. If no matching
  * registration is found, this function returns false.
@@ -69,6 +157,14 @@ CT_API b8 eventRegister(u16 code, void* listener, PF_on_event on_event);
  */
 CT_API b8 eventUnregister(u16 code, void* listener, PF_on_event on_event);
 
+/**
+ * Unregisters what eventRegisterHandle registered. Safe to call from inside a
+ * listener, the listener is skipped from then on.
+ * @param handle The handle from eventRegisterHandle.
+ * @returns true if unregistered, false if the handle was stale or invalid.
+ */
+CT_API b8 eventUnregisterHandle(eventHandle handle);
+
 /**
  * Fires an event to listeners of the given code. If an event handler returns 
  * true, the event is considered handled and is not passed on to any more listeners.
@@ -79,6 +175,64 @@ CT_API b8 eventUnregister(u16 code, void* listener, PF_on_event on_event);
  */
 CT_API b8 eventFire(u16 code, void* sender, eventContext context);
 
+/**
+ * Queues an event to be sent on the next eventDispatchQueued instead of
+ * running the listeners at the call site. Events posted by listeners during
+ * a dispatch wait for the one after it.
+ * Safe to call from any thread. Posts from threads other than the one that
+ * called eventInit go through a lock-free queue and are dispatched on the
+ * owning thread, after that thread's own posts.
+ * @param code The event code to post.
+ * @param sender A pointer to the sender. Can be 0/NULL, must still be valid at dispatch.
+ * @param context The event data.
+ * @returns true if queued. false if the queue was full: the event was fired
+ * right away on the owning thread and dropped on any other.
+ */
+CT_API b8 eventPost(u16 code, void* sender, eventContext context);
+
+/**
+ * Sends every queued event, grouped by code: each code's listeners get all of
+ * that code's events in one go, in the order they were posted. Codes go in
+ * the order they were first posted. Call once per frame on the main thread.
+ */
+CT_API void eventDispatchQueued();
+
+/**
+ * Sets how posted events of a code are collapsed before dispatch. Only the
+ * latest queued event of the code is looked at, so with DROP_DUPLICATE
+ * A, B, A stays three events. eventFire is never affected.
+ * Mouse moves and resizes keep the latest, the wheel accumulates i8 lanes and
+ * key/button down drop duplicates by default.
+ * @param code The event code.
+ * @param policy The eventCoalescing policy.
+ */
+CT_API void eventSetCoalescing(u16 code, eventCoalescing policy);
+
+
+/**
+ * Gets a code's counters. Only filled in with EVENT_STATS_ENABLED.
+ * @returns false if stats are compiled out or the code is invalid.
+ */
+CT_API b8 eventStatsGetCode(u16 code, eventCodeStats* outStats);
+
+/**
+ * Gets the counters of the listener registered under handle. Only filled in
+ * with EVENT_STATS_ENABLED.
+ * @returns false if stats are compiled out or the handle is stale.
+ */
+CT_API b8 eventStatsGetListener(eventHandle handle, eventListenerStats* outStats);
+
+/**
+ * Logs the busiest codes and the listeners that took the most time. Runs on
+ * its own every EVENT_STATS_LOG_INTERVAL seconds, each summary starting the
+ * counters over. Does nothing when stats are compiled out.
+ */
+CT_API void eventStatsLogSummary();
+
+/**
+ * Zeroes every counter.
+ */
+CT_API void eventStatsReset();
 
 typedef enum systemEventCode {
     /** @brief Shuts the application down on the next frame. */
@@ -128,6 +282,13 @@ typedef enum systemEventCode {
      */
     EVENT_CODE_RESIZED = 0x08,
 
+    /** @brief The window was minimized, covered up or lost focus, or the
+     * other way around.
+     * Context usage:
+     * u32 flags = data.data.u32[0]; - platformWindowFlags
+     */
+    EVENT_CODE_WINDOW_STATE = 0x09,
+
     // Change the render mode for debugging purposes.
     /* Context usage:
      * i32 mode = context.data.i32[0];
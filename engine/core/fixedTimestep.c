@@ -0,0 +1,72 @@
+#include "fixedTimestep.h"
+
+#include "core/logger.h"
+
+typedef struct fixedTimestepState {
+    f64 tickDelta;
+    u32 maxTicksPerFrame;
+    // Time not simulated yet
+    f64 accumulator;
+    u64 ticks;
+    u64 dropped;
+    // Dropped since the last warning
+    u64 droppedSinceWarn;
+    f64 sinceWarn;
+} fixedTimestepState;
+
+static fixedTimestepState state;
+
+void fixedTimestepInit(f64 tickRate, u32 maxTicksPerFrame) {
+    state.tickDelta = 1.0 / (tickRate > 0 ? tickRate : 60.0);
+    state.maxTicksPerFrame = maxTicksPerFrame ? maxTicksPerFrame : 1;
+    state.accumulator = 0;
+    state.ticks = 0;
+    state.dropped = 0;
+    state.droppedSinceWarn = 0;
+    state.sinceWarn = 0;
+}
+
+u32 fixedTimestepAdvance(f64 frameDelta) {
+    state.accumulator += frameDelta > 0 ? frameDelta : 0;
+    u64 ticks = (u64)(state.accumulator / state.tickDelta);
+    if (ticks > state.maxTicksPerFrame) {
+        // Keep the fraction so the alpha doesn't jump
+        u64 drop = ticks - state.maxTicksPerFrame;
+        state.accumulator -= drop * state.tickDelta;
+        state.dropped += drop;
+        state.droppedSinceWarn += drop;
+        ticks = state.maxTicksPerFrame;
+    }
+    state.accumulator -= ticks * state.tickDelta;
+    // Rounding can leave it a hair under 0
+    if (state.accumulator < 0) {
+        state.accumulator = 0;
+    }
+    state.ticks += ticks;
+
+    state.sinceWarn += frameDelta;
+    if (state.droppedSinceWarn && state.sinceWarn >= FIXED_TIMESTEP_WARN_INTERVAL) {
+        FWARN("Simulation fell behind, dropped %llu ticks in the last %.1f s.",
+              state.droppedSinceWarn, state.sinceWarn);
+        state.droppedSinceWarn = 0;
+        state.sinceWarn = 0;
+    }
+    return (u32)ticks;
+}
+
+f64 fixedTimestepDelta() {
+    return state.tickDelta;
+}
+
+f32 fixedTimestepAlpha() {
+    f32 alpha = (f32)(state.accumulator / state.tickDelta);
+    return alpha < 1.0f ? alpha : 0.999999f;
+}
+
+u64 fixedTimestepTicks() {
+    return state.ticks;
+}
+
+u64 fixedTimestepDroppedTicks() {
+    return state.dropped;
+}
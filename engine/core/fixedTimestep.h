@@ -0,0 +1,54 @@
+#pragma once
+
+#include "defines.h"
+
+/**
+ *  Fixed timestep accumulator for the simulation. Every frame adds the
+ * time it took and gets back how many ticks of exactly 1 / tickRate seconds
+ * to simulate, so the simulation comes out the same whatever the frame rate.
+ *
+ *  When frames fall far behind, at most maxTicksPerFrame are run and the
+ * rest of the time is dropped. Simulating more to catch up would only make
+ * the next frame slower still.
+ *
+ *  What's left over is less than a tick. fixedTimestepAlpha is how far into
+ * the next tick it is, for drawing between the last two simulated states.
+ */
+
+// Seconds between warnings about dropped time
+#define FIXED_TIMESTEP_WARN_INTERVAL 5.0
+
+/**
+ * @param tickRate Simulation ticks per second
+ * @param maxTicksPerFrame Most ticks a single frame runs, at least 1
+ */
+CT_API void fixedTimestepInit(f64 tickRate, u32 maxTicksPerFrame);
+
+/**
+ * @brief Adds a frame's time.
+ * @param frameDelta Seconds since the last frame
+ * @returns Ticks to simulate this frame
+ */
+CT_API u32 fixedTimestepAdvance(f64 frameDelta);
+
+/**
+ * @brief Seconds per tick.
+ */
+CT_API f64 fixedTimestepDelta();
+
+/**
+ * @brief Time left over after this frame's ticks as a fraction of a tick, in
+ * [0, 1).
+ */
+CT_API f32 fixedTimestepAlpha();
+
+/**
+ * @brief Ticks simulated so far.
+ */
+CT_API u64 fixedTimestepTicks();
+
+/**
+ * @brief Ticks' worth of time dropped so far because frames fell too far
+ * behind.
+ */
+CT_API u64 fixedTimestepDroppedTicks();
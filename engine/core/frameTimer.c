@@ -0,0 +1,161 @@
+#include "frameTimer.h"
+
+#include "core/fmemory.h"
+#include "core/logger.h"
+#include "platform/platform.h"
+
+#include <stdlib.h>
+
+// Starting guess for how much the OS oversleeps
+#define INITIAL_SLACK_NS 1000000
+
+typedef struct frameTimerState {
+    u64 periodNs;
+    u64 lastTick;
+    // When the current frame should end, advanced a period at a time so
+    // the rate doesn't drift
+    u64 deadline;
+    // Time the current frame worked before frameTimerLimit, 0 if not called
+    u64 busyNs;
+    // How long before a deadline to stop sleeping and start spinning
+    u64 slackNs;
+
+    f32 frameMs[FRAME_TIMER_SAMPLES];
+    f32 busyMs[FRAME_TIMER_SAMPLES];
+    u32 next;
+    u32 count;
+    // Sort scratch for the percentiles
+    f32 sorted[FRAME_TIMER_SAMPLES];
+    u64 lastLog;
+} frameTimerState;
+
+static frameTimerState state;
+
+void frameTimerInit(f64 targetRate) {
+    fzeroMemory(&state, sizeof(frameTimerState));
+    state.slackNs = INITIAL_SLACK_NS;
+    frameTimerSetTargetRate(targetRate);
+}
+
+void frameTimerSetTargetRate(f64 targetRate) {
+    state.periodNs = targetRate > 0 ? (u64)(1000000000.0 / targetRate) : 0;
+    // Start the new cadence from the current frame
+    state.deadline = state.lastTick;
+}
+
+f64 frameTimerTick() {
+    u64 now = platformGetAbsoluteTimeNs();
+    if (!state.lastTick) {
+        state.lastTick = now;
+        state.deadline = now;
+        if (!state.lastLog) {
+            state.lastLog = now;
+        }
+        return 0;
+    }
+
+    u64 delta = now - state.lastTick;
+    u64 busy = state.busyNs ? state.busyNs : delta;
+    state.frameMs[state.next] = (f32)(delta / 1000000.0);
+    state.busyMs[state.next] = (f32)(busy / 1000000.0);
+    state.next = (state.next + 1) % FRAME_TIMER_SAMPLES;
+    if (state.count < FRAME_TIMER_SAMPLES) {
+        state.count++;
+    }
+    state.lastTick = now;
+    state.busyNs = 0;
+
+    if (FRAME_TIMER_LOG_INTERVAL > 0 &&
+        now - state.lastLog >= (u64)(FRAME_TIMER_LOG_INTERVAL * 1000000000.0)) {
+        frameTimerLogSummary();
+        state.lastLog = now;
+    }
+    return delta / 1000000000.0;
+}
+
+void frameTimerLimit() {
+    u64 now = platformGetAbsoluteTimeNs();
+    state.busyNs = now - state.lastTick;
+    if (!state.periodNs) {
+        return;
+    }
+
+    state.deadline += state.periodNs;
+    // More than a frame behind, catching up would just mean a burst of
+    // unlimited frames. Start over from now.
+    if (state.deadline + state.periodNs < now) {
+        state.deadline = now;
+    }
+    if (now >= state.deadline) {
+        return;
+    }
+
+    u64 remaining = state.deadline - now;
+    if (remaining > state.slackNs) {
+        u64 request = remaining - state.slackNs;
+        platformSleepNs(request);
+        u64 slept = platformGetAbsoluteTimeNs() - now;
+        u64 over = slept > request ? slept - request : 0;
+        // Jump up to oversleeps right away, come back down over a few
+        // frames. Capped at half a frame, one scheduler hiccup shouldn't
+        // turn the limiter into a busy loop.
+        u64 slack = over + over / 4;
+        u64 decayed = state.slackNs - state.slackNs / 8;
+        state.slackNs = slack > decayed ? slack : decayed;
+        if (state.slackNs < FRAME_TIMER_MIN_SPIN_NS) {
+            state.slackNs = FRAME_TIMER_MIN_SPIN_NS;
+        } else if (state.slackNs > state.periodNs / 2) {
+            state.slackNs = state.periodNs / 2;
+        }
+    }
+
+    while (platformGetAbsoluteTimeNs() < state.deadline) {
+        FSN_CPU_RELAX();
+    }
+}
+
+void frameTimerSkip() {
+    state.lastTick = 0;
+    state.busyNs = 0;
+}
+
+static int compareF32(const void* a, const void* b) {
+    f32 fa = *(const f32*)a;
+    f32 fb = *(const f32*)b;
+    return (fa > fb) - (fa < fb);
+}
+
+b8 frameTimerGetStats(frameTimerStats* outStats) {
+    fzeroMemory(outStats, sizeof(frameTimerStats));
+    u32 count = state.count;
+    if (!count) {
+        return false;
+    }
+
+    f64 frameSum = 0;
+    f64 busySum = 0;
+    for (u32 i = 0; i < count; i++) {
+        frameSum += state.frameMs[i];
+        busySum += state.busyMs[i];
+    }
+    fcopyMemory(state.sorted, state.frameMs, count * sizeof(f32));
+    qsort(state.sorted, count, sizeof(f32), compareF32);
+
+    outStats->samples = count;
+    outStats->mean = (f32)(frameSum / count);
+    outStats->p95 = state.sorted[(count - 1) * 95 / 100];
+    outStats->p99 = state.sorted[(count - 1) * 99 / 100];
+    outStats->max = state.sorted[count - 1];
+    outStats->busyMean = (f32)(busySum / count);
+    return true;
+}
+
+void frameTimerLogSummary() {
+    frameTimerStats stats;
+    if (!frameTimerGetStats(&stats)) {
+        return;
+    }
+    FINFO("Frame time over %u frames (ms): mean %.2f p95 %.2f p99 %.2f max %.2f, "
+          "busy %.2f",
+          stats.samples, stats.mean, stats.p95, stats.p99, stats.max, stats.busyMean);
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "defines.h"
+
+/**
+ *  Frame timing and pacing for the main loop. frameTimerTick at the top of
+ * a frame measures how long the last one really took, frameTimerLimit at the
+ * bottom holds the loop to the target rate.
+ *
+ *  The limiter sleeps for most of what's left of the frame and spins out
+ * the rest on the nanosecond clock. How early it stops sleeping follows how
+ * much the OS has been oversleeping lately, so it only spins as long as it
+ * has to.
+ */
+
+// Frame times kept for the percentiles
+#define FRAME_TIMER_SAMPLES 1024
+// Seconds between the summaries logged from frameTimerTick. 0 turns them off.
+#ifndef FRAME_TIMER_LOG_INTERVAL
+#define FRAME_TIMER_LOG_INTERVAL 10.0
+#endif
+// Shortest the limiter spins for before a deadline, in nanoseconds
+#define FRAME_TIMER_MIN_SPIN_NS 200000
+
+/** @brief Frame times in milliseconds. */
+typedef struct frameTimerStats {
+    /** @brief Frames the stats are taken over. */
+    u32 samples;
+    f32 mean;
+    f32 p95;
+    f32 p99;
+    f32 max;
+    /** @brief Mean time a frame spent working, without the limiter's wait. */
+    f32 busyMean;
+} frameTimerStats;
+
+/**
+ * @brief Resets the timer and sets the target rate.
+ * @param targetRate Frames per second, 0 for no limit
+ */
+CT_API void frameTimerInit(f64 targetRate);
+
+/**
+ * @param targetRate Frames per second, 0 for no limit
+ */
+CT_API void frameTimerSetTargetRate(f64 targetRate);
+
+/**
+ * @brief Call at the start of every frame.
+ * @returns Seconds since the last call, 0 on the first
+ */
+CT_API f64 frameTimerTick();
+
+/**
+ * @brief Call at the end of every frame. Waits until the frame's share of
+ * the target rate is used up, returns right away without a target.
+ */
+CT_API void frameTimerLimit();
+
+/**
+ * @brief Call instead of a frame while the app isn't drawing, e.g. minimized.
+ * The next frameTimerTick returns 0 and the cadence starts over from there,
+ * so time spent idle isn't counted as one long frame.
+ */
+CT_API void frameTimerSkip();
+
+/**
+ * @brief Stats over the last FRAME_TIMER_SAMPLES frames.
+ * @returns false if no frame has finished yet
+ */
+CT_API b8 frameTimerGetStats(frameTimerStats* outStats);
+
+/**
+ * @brief Logs the current stats.
+ */
+CT_API void frameTimerLogSummary();
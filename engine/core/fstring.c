@@ -1,14 +1,12 @@
 #include "core/fstring.h"
 #include "core/fmemory.h"
+#include "core/fstringSimd.h"
 #include "helpers/dinoarray.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdarg.h>
-#include <ctype.h>  // isspace
-
-#ifndef _MSC_VER
-#include <strings.h>
-#endif
+#include <stdlib.h> // strtod/strtof, only for the slow path
+#include <math.h>   // nextafterf, INFINITY, NAN
 
 /**
  * This is all stolen from somewhere.
@@ -16,7 +14,7 @@
 */
 
 u64 strLen(const char* str) {
-    return strlen(str);
+    return strKernel.len(str);
 }
 
 char* strDup(const char* str) {
@@ -45,11 +43,11 @@ b8 strEqual(const char* str0, const char* str1) {
 
 // Case-insensitive string comparison. True if the same, otherwise false.
 b8 strEqualI(const char* str0, const char* str1) {
-#if defined(__GNUC__)
-    return strcasecmp(str0, str1) == 0;
-#elif defined(_MSC_VER)
-    return _strcmpi(str0, str1) == 0;
-#endif
+    u64 len = strLen(str0);
+    if (len != strLen(str1)) {
+        return false;
+    }
+    return strKernel.equalI(str0, str1, len);
 }
 
 char* strCpy(char* dest, const char* source) {
@@ -109,18 +107,12 @@ void strCut(char* dest, const char* source, i32 start, i32 length) {
 }
 
 char* strTrim(char* str) {
-    while (isspace((unsigned char)*str)) {
-        str++;
-    }
-    if (*str) {
-        char* p = str;
-        while (*p) {
-            p++;
-        }
-        while (isspace((unsigned char)*(--p)))
-            ;
-
-        p[1] = '\0';
+    u64 len = strLen(str);
+    u64 lead = strKernel.skipSpace(str, len);
+    str += lead;
+    len -= lead;
+    if (len) {
+        str[len - strKernel.skipSpaceRev(str, len)] = '\0';
     }
 
     return str;
@@ -132,149 +124,637 @@ u32 strSplit(const char* str, char delimeter, char*** strDinoArray, b8 trimIt,
         return 0;
     }
 
-    char* r = 0;
     u32 valCnt = 0;
-    u32 len = strLen(str);
-    char buffer[10000];
-    u32 curLen = 0;
-    char c;
-    // Loop through the characters
-    for (u32 i = 0; i < len; i++) {
-        c = str[i];
-        if (c == delimeter) {
-            buffer[curLen] = 0;
-            r = buffer;
-            if (trimIt && curLen > 0) {
-                r = strTrim(r);
-                curLen = strLen(r);
+    strView remaining = strViewFromCStr(str);
+    strView field;
+    while (strSplitViewNext(&remaining, delimeter, &field)) {
+        if (trimIt) {
+            field = strTrimView(field);
+        }
+
+        if (field.len > 0 || includeZeroCharLines) {
+            dinoPush(*strDinoArray, strViewDup(field));
+            valCnt++;
+        }
+    }
+    return valCnt;
+}
+
+void strCleanDinoArray(char** a){
+    if (a){
+        u32 l = dinoLength(a);
+        for (u32 i = 0; i < l; i++){
+            u32 x = strLen(a[i]);
+            ffree(a[i], sizeof(char) * (x + 1), MEMORY_TAG_STRING);
+        }
+
+        dinoClear(a);
+    }
+}
+
+i32 strIdxOf(const char* str, char c) {
+    if (!str) {
+        return -1;
+    }
+    return strKernel.findChar(str, strLen(str), c);
+}
+
+//====================== String Views ======================
+
+strView strViewFromCStr(const char* str) {
+    strView v;
+    v.ptr = str;
+    v.len = str ? strLen(str) : 0;
+    return v;
+}
+
+strView strViewMake(const char* ptr, u64 len) {
+    strView v;
+    v.ptr = ptr;
+    v.len = len;
+    return v;
+}
+
+strView strViewSub(strView v, u64 start, i64 length) {
+    if (start >= v.len) {
+        return strViewMake(v.ptr + v.len, 0);
+    }
+    u64 left = v.len - start;
+    if (length < 0 || (u64)length > left) {
+        return strViewMake(v.ptr + start, left);
+    }
+    return strViewMake(v.ptr + start, length);
+}
+
+char* strViewDup(strView v) {
+    char* copy = fallocate(v.len + 1, MEMORY_TAG_STRING);
+    if (v.len) {
+        fcopyMemory(copy, v.ptr, v.len);
+    }
+    copy[v.len] = 0;
+    return copy;
+}
+
+u64 strViewCopy(char* dest, strView v, u64 destSize) {
+    if (!dest || destSize == 0) {
+        return 0;
+    }
+    u64 len = v.len < destSize - 1 ? v.len : destSize - 1;
+    if (len) {
+        fcopyMemory(dest, v.ptr, len);
+    }
+    dest[len] = 0;
+    return len;
+}
+
+strView strTrimView(strView v) {
+    u64 lead = strKernel.skipSpace(v.ptr, v.len);
+    v.ptr += lead;
+    v.len -= lead;
+    v.len -= strKernel.skipSpaceRev(v.ptr, v.len);
+    return v;
+}
+
+i64 strIdxOfView(strView v, char c) {
+    if (!v.ptr || v.len == 0) {
+        return -1;
+    }
+    return strKernel.findChar(v.ptr, v.len, c);
+}
+
+b8 strViewEqual(strView v0, strView v1) {
+    if (v0.len != v1.len) {
+        return false;
+    }
+    return v0.len == 0 || memcmp(v0.ptr, v1.ptr, v0.len) == 0;
+}
+
+b8 strViewEqualI(strView v0, strView v1) {
+    if (v0.len != v1.len) {
+        return false;
+    }
+    return strKernel.equalI(v0.ptr, v1.ptr, v0.len);
+}
+
+b8 strViewEqualCStr(strView v, const char* str) {
+    return strViewEqual(v, strViewFromCStr(str));
+}
+
+b8 strViewEqualICStr(strView v, const char* str) {
+    return strViewEqualI(v, strViewFromCStr(str));
+}
+
+b8 strSplitViewNext(strView* remaining, char delimeter, strView* outToken) {
+    // A null ptr marks that the last field has already been handed out.
+    if (!remaining || !remaining->ptr) {
+        return false;
+    }
+
+    i64 idx = strIdxOfView(*remaining, delimeter);
+    if (idx == -1) {
+        *outToken = *remaining;
+        remaining->ptr = 0;
+        remaining->len = 0;
+        return true;
+    }
+
+    *outToken = strViewMake(remaining->ptr, idx);
+    remaining->ptr += idx + 1;
+    remaining->len -= idx + 1;
+    return true;
+}
+
+u32 strSplitView(strView str, char delimeter, strView* outViews, u32 maxViews,
+                 b8 trimIt, b8 includeZeroCharLines) {
+    if (!str.ptr || !outViews) {
+        return 0;
+    }
+
+    u32 valCnt = 0;
+    strView field;
+    while (valCnt < maxViews && strSplitViewNext(&str, delimeter, &field)) {
+        if (trimIt) {
+            field = strTrimView(field);
+        }
+
+        if (field.len > 0 || includeZeroCharLines) {
+            outViews[valCnt] = field;
+            valCnt++;
+        }
+    }
+    return valCnt;
+}
+
+//====================== Number Parsing ======================
+
+/*
+ * Hand rolled so it doesn't depend on the locale and never allocates.
+ * Floats take the exact fast path (Clinger) when the mantissa and power of ten
+ * are both exactly representable. Only numbers outside of that (more than 19
+ * significant digits, huge exponents, exact float ties) fall back to strtod.
+ * The slow path rewrites the number into a stack buffer as digits and an
+ * exponent with no decimal point. That keeps LC_NUMERIC's decimal separator
+ * out of it, so results always round the same as strtod/strtof in the C
+ * locale, whatever the length of the number.
+ */
+
+// Significant digits handed to strtod. Enough to round any double correctly,
+// past that it only matters whether the rest are all zero, which a trailing 1
+// stands in for.
+#define SLOW_PATH_DIGITS 768
+
+static const f64 pow10F64[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                               1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                               1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+static const f32 pow10F32[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f,
+                               1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+
+FSN_INLINE b8 isDigit(char c) {
+    return (u8)(c - '0') <= 9;
+}
+
+// The pieces of a decimal number. value = mantissa * 10^exponent
+typedef struct decimalParts {
+    b8 negative;
+    b8 truncated;
+    u64 mantissa;
+    i64 exponent;
+    // Span of the whole number in the source view
+    const char* start;
+    u64 len;
+} decimalParts;
+
+static u64 skipLeadingSpace(strView* v) {
+    u64 lead = strKernel.skipSpace(v->ptr, v->len);
+    v->ptr += lead;
+    v->len -= lead;
+    return lead;
+}
+
+static b8 parseDecimal(strView v, decimalParts* out) {
+    u64 i = 0;
+    out->negative = false;
+    out->truncated = false;
+    out->mantissa = 0;
+    out->exponent = 0;
+    out->start = v.ptr;
+
+    if (i < v.len && (v.ptr[i] == '-' || v.ptr[i] == '+')) {
+        out->negative = v.ptr[i] == '-';
+        i++;
+    }
+
+    u32 sigDigits = 0;
+    u32 digitCnt = 0;
+    for (; i < v.len && isDigit(v.ptr[i]); i++, digitCnt++) {
+        if (sigDigits < 19) {
+            out->mantissa = out->mantissa * 10 + (v.ptr[i] - '0');
+            sigDigits += out->mantissa != 0;
+        } else {
+            // Digit doesn't fit, only its magnitude is kept
+            out->exponent++;
+            out->truncated |= v.ptr[i] != '0';
+        }
+    }
+
+    if (i < v.len && v.ptr[i] == '.') {
+        i++;
+        for (; i < v.len && isDigit(v.ptr[i]); i++, digitCnt++) {
+            if (sigDigits < 19) {
+                out->mantissa = out->mantissa * 10 + (v.ptr[i] - '0');
+                sigDigits += out->mantissa != 0;
+                out->exponent--;
+            } else {
+                out->truncated |= v.ptr[i] != '0';
             }
+        }
+    }
 
-            if (curLen > 0 || includeZeroCharLines) {
-                char* val =
-                    fallocate(sizeof(char) * (curLen + 1), MEMORY_TAG_STRING);
+    if (digitCnt == 0) {
+        return false;
+    }
 
-                if (curLen == 0) {
-                    val[0] = 0;
-                } else {
-                    strNCpy(val, r, curLen);
-                    val[curLen] = 0;
+    // Exponent only counts if it actually has digits. "1e" is just 1
+    if (i < v.len && (v.ptr[i] == 'e' || v.ptr[i] == 'E')) {
+        u64 e = i + 1;
+        b8 expNegative = false;
+        if (e < v.len && (v.ptr[e] == '-' || v.ptr[e] == '+')) {
+            expNegative = v.ptr[e] == '-';
+            e++;
+        }
+        if (e < v.len && isDigit(v.ptr[e])) {
+            i64 exp = 0;
+            for (; e < v.len && isDigit(v.ptr[e]); e++) {
+                // Clamp. Anything this big is inf/0 anyway
+                if (exp < 100000) {
+                    exp = exp * 10 + (v.ptr[e] - '0');
                 }
-                dinoPush(*strDinoArray, val);
-                valCnt++;
             }
+            out->exponent += expNegative ? -exp : exp;
+            i = e;
+        }
+    }
+
+    out->len = i;
+    return true;
+}
+
+// Matches inf/infinity/nan. Returns the amount of characters matched.
+static u64 parseSpecial(strView v, f64* out) {
+    u64 i = 0;
+    b8 negative = false;
+    if (i < v.len && (v.ptr[i] == '-' || v.ptr[i] == '+')) {
+        negative = v.ptr[i] == '-';
+        i++;
+    }
+    strView rest = strViewSub(v, i, -1);
+    if (strViewEqualICStr(strViewSub(rest, 0, 8), "infinity")) {
+        *out = negative ? -INFINITY : INFINITY;
+        return i + 8;
+    }
+    if (strViewEqualICStr(strViewSub(rest, 0, 3), "inf")) {
+        *out = negative ? -INFINITY : INFINITY;
+        return i + 3;
+    }
+    if (strViewEqualICStr(strViewSub(rest, 0, 3), "nan")) {
+        *out = negative ? -NAN : NAN;
+        return i + 3;
+    }
+    return 0;
+}
 
-            fzeroMemory(buffer, sizeof(char) * 10000);
-            curLen = 0;
+// Exact double result if the fast path applies.
+static b8 decimalToF64Fast(const decimalParts* d, f64* out) {
+    if (d->truncated || d->mantissa > (1ull << 53) || d->exponent < -22 ||
+        d->exponent > 22) {
+        return false;
+    }
+    f64 value = (f64)d->mantissa;
+    if (d->exponent < 0) {
+        value /= pow10F64[-d->exponent];
+    } else {
+        value *= pow10F64[d->exponent];
+    }
+    *out = d->negative ? -value : value;
+    return true;
+}
+
+// Writes the number as "[-]<digits>e<exponent>" into buffer, which needs
+// room for SLOW_PATH_DIGITS + 32 characters.
+static void decimalToCString(const decimalParts* d, char* buffer) {
+    const char* p = d->start;
+    u64 i = 0;
+    u64 n = 0;
+    if (d->negative) {
+        buffer[n++] = '-';
+    }
+    if (i < d->len && (p[i] == '-' || p[i] == '+')) {
+        i++;
+    }
+
+    u32 digits = 0;
+    i64 exponent = 0;
+    b8 fraction = false;
+    b8 sticky = false;
+    for (; i < d->len && p[i] != 'e' && p[i] != 'E'; i++) {
+        if (p[i] == '.') {
+            fraction = true;
             continue;
         }
+        if (digits == 0 && p[i] == '0') {
+            // Leading zero, only its place counts
+            exponent -= fraction;
+        } else if (digits < SLOW_PATH_DIGITS) {
+            buffer[n++] = p[i];
+            digits++;
+            exponent -= fraction;
+        } else {
+            exponent += !fraction;
+            sticky |= p[i] != '0';
+        }
+    }
+    if (digits == 0) {
+        buffer[n++] = '0';
+    }
+    if (sticky) {
+        buffer[n++] = '1';
+        exponent--;
+    }
+
+    // parseDecimal only took the exponent in if it has digits
+    if (i < d->len) {
+        i++;
+        b8 expNegative = false;
+        if (p[i] == '-' || p[i] == '+') {
+            expNegative = p[i] == '-';
+            i++;
+        }
+        i64 exp = 0;
+        for (; i < d->len; i++) {
+            if (exp < 100000) {
+                exp = exp * 10 + (p[i] - '0');
+            }
+        }
+        exponent += expNegative ? -exp : exp;
+    }
 
-        buffer[curLen] = c;
-        curLen++;
+    buffer[n++] = 'e';
+    if (exponent < 0) {
+        buffer[n++] = '-';
+        exponent = -exponent;
+    }
+    char reversed[24];
+    u32 r = 0;
+    do {
+        reversed[r++] = (char)('0' + exponent % 10);
+        exponent /= 10;
+    } while (exponent);
+    while (r) {
+        buffer[n++] = reversed[--r];
     }
+    buffer[n] = 0;
+}
+
+static void decimalSlowF64(const decimalParts* d, f64* out) {
+    char buffer[SLOW_PATH_DIGITS + 32];
+    decimalToCString(d, buffer);
+    *out = strtod(buffer, 0);
+}
 
-    r = buffer;
-    if (trimIt && curLen > 0) {
-        r = strTrim(r);
-        len = strLen(r);
+static b8 decimalToF64(const decimalParts* d, f64* out) {
+    if (d->mantissa == 0 && !d->truncated) {
+        *out = d->negative ? -0.0 : 0.0;
+        return true;
     }
+    if (!decimalToF64Fast(d, out)) {
+        decimalSlowF64(d, out);
+    }
+    return true;
+}
 
-    if (len > 0 || includeZeroCharLines) {
-        char* val = fallocate(sizeof(char) * (len + 1), MEMORY_TAG_STRING);
+static b8 decimalToF32(const decimalParts* d, f32* out) {
+    if (d->mantissa == 0 && !d->truncated) {
+        *out = d->negative ? -0.0f : 0.0f;
+        return true;
+    }
 
-        if (len == 0) {
-            val[0] = 0;
+    // Both operands exact in a float so the single rounding is correct
+    if (!d->truncated && d->mantissa <= (1ull << 24) && d->exponent >= -10 &&
+        d->exponent <= 10) {
+        f32 value = (f32)d->mantissa;
+        if (d->exponent < 0) {
+            value /= pow10F32[-d->exponent];
         } else {
-            strNCpy(val, r, len);
-            val[len] = 0;
+            value *= pow10F32[d->exponent];
         }
-        dinoPush(*strDinoArray, val);
+        *out = d->negative ? -value : value;
+        return true;
     }
-    valCnt++;
-    return valCnt;
+
+    // Correctly rounded double, then to float. That only double-rounds wrong
+    // when the double lands exactly halfway between two floats.
+    f64 wide;
+    if (decimalToF64Fast(d, &wide)) {
+        f32 narrow = (f32)wide;
+        if ((f64)narrow == wide) {
+            *out = narrow;
+            return true;
+        }
+        f32 other = nextafterf(narrow, wide > (f64)narrow ? INFINITY
+                                                          : -INFINITY);
+        if (((f64)narrow + (f64)other) * 0.5 != wide) {
+            *out = narrow;
+            return true;
+        }
+    }
+
+    char buffer[SLOW_PATH_DIGITS + 32];
+    decimalToCString(d, buffer);
+    *out = strtof(buffer, 0);
+    return true;
 }
 
-void strCleanDinoArray(char** a){
-    if (a){
-        u32 l = dinoLength(a);
-        for (u32 i = 0; i < l; i++){
-            u32 x = strLen(a[i]);
-            ffree(a[i], sizeof(char) * (x + 1), MEMORY_TAG_STRING);
+b8 strViewParseF64(strView* v, f64* f) {
+    if (!v || !v->ptr || !f) {
+        return false;
+    }
+    strView s = *v;
+    skipLeadingSpace(&s);
+
+    decimalParts d;
+    if (parseDecimal(s, &d)) {
+        if (!decimalToF64(&d, f)) {
+            return false;
         }
+        *v = strViewSub(s, d.len, -1);
+        return true;
+    }
 
-        dinoClear(a);
+    u64 special = parseSpecial(s, f);
+    if (special) {
+        *v = strViewSub(s, special, -1);
+        return true;
     }
+    return false;
 }
 
-i32 strIdxOf(const char* str, char c) {
-    if (!str) {
-        return -1;
+b8 strViewParseF32(strView* v, f32* f) {
+    if (!v || !v->ptr || !f) {
+        return false;
     }
-    u32 length = strLen(str);
-    if (length > 0) {
-        for (u32 i = 0; i < length; ++i) {
-            if (str[i] == c) {
-                return i;
-            }
+    strView s = *v;
+    skipLeadingSpace(&s);
+
+    decimalParts d;
+    if (parseDecimal(s, &d)) {
+        if (!decimalToF32(&d, f)) {
+            return false;
         }
+        *v = strViewSub(s, d.len, -1);
+        return true;
     }
 
-    return -1;
+    f64 wide;
+    u64 special = parseSpecial(s, &wide);
+    if (special) {
+        *f = (f32)wide;
+        *v = strViewSub(s, special, -1);
+        return true;
+    }
+    return false;
+}
+
+u32 strViewParseF32List(strView v, f32* outValues, u32 maxCnt) {
+    if (!outValues) {
+        return 0;
+    }
+    u32 cnt = 0;
+    while (cnt < maxCnt && strViewParseF32(&v, &outValues[cnt])) {
+        cnt++;
+        // Allow "1, 2, 3" as well as "1 2 3"
+        skipLeadingSpace(&v);
+        if (v.len && v.ptr[0] == ',') {
+            v.ptr++;
+            v.len--;
+        }
+    }
+    return cnt;
+}
+
+// Parses the digits of an unsigned number in base. Fails on overflow.
+static b8 parseDigits(strView* v, u32 base, u64* out) {
+    u64 value = 0;
+    u64 i = 0;
+    for (; i < v->len; i++) {
+        char c = v->ptr[i];
+        u32 digit;
+        if (isDigit(c)) {
+            digit = c - '0';
+        } else if ((u8)((c | 0x20) - 'a') < 6) {
+            digit = (c | 0x20) - 'a' + 10;
+        } else {
+            break;
+        }
+        if (digit >= base) {
+            break;
+        }
+        if (value > (~0ull - digit) / base) {
+            return false;
+        }
+        value = value * base + digit;
+    }
+    if (i == 0) {
+        return false;
+    }
+    *out = value;
+    v->ptr += i;
+    v->len -= i;
+    return true;
+}
+
+b8 strViewParseI64(strView* v, i64* i) {
+    if (!v || !v->ptr || !i) {
+        return false;
+    }
+    strView s = *v;
+    skipLeadingSpace(&s);
+
+    b8 negative = false;
+    if (s.len && (s.ptr[0] == '-' || s.ptr[0] == '+')) {
+        negative = s.ptr[0] == '-';
+        s = strViewSub(s, 1, -1);
+    }
+
+    // Same prefixes as scanf's %i. 0x for hex, a leading 0 for octal
+    u32 base = 10;
+    if (s.len > 2 && s.ptr[0] == '0' && (s.ptr[1] | 0x20) == 'x' &&
+        (isDigit(s.ptr[2]) || (u8)((s.ptr[2] | 0x20) - 'a') < 6)) {
+        base = 16;
+        s = strViewSub(s, 2, -1);
+    } else if (s.len > 1 && s.ptr[0] == '0') {
+        base = 8;
+    }
+
+    u64 magnitude;
+    if (!parseDigits(&s, base, &magnitude)) {
+        return false;
+    }
+    if (magnitude > (negative ? (1ull << 63) : (u64)((1ull << 63) - 1))) {
+        return false;
+    }
+    *i = negative ? (i64)(0 - magnitude) : (i64)magnitude;
+    *v = s;
+    return true;
+}
+
+b8 strViewParseU64(strView* v, u64* u) {
+    if (!v || !v->ptr || !u) {
+        return false;
+    }
+    strView s = *v;
+    skipLeadingSpace(&s);
+    if (s.len && s.ptr[0] == '+') {
+        s = strViewSub(s, 1, -1);
+    }
+    if (!parseDigits(&s, 10, u)) {
+        return false;
+    }
+    *v = s;
+    return true;
+}
+
+static b8 strToFloats(const char* str, f32* outValues, u32 cnt) {
+    fzeroMemory(outValues, sizeof(f32) * cnt);
+    return strViewParseF32List(strViewFromCStr(str), outValues, cnt) == cnt;
 }
 
 b8 strToMat4(const char* str, mat4* outMat) {
     if (!str || !outMat) {
         return false;
     }
-
-    fzeroMemory(outMat, sizeof(mat4));
-    i32 result = sscanf(str, "%f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f",
-                        &outMat->data[0],
-                        &outMat->data[1],
-                        &outMat->data[2],
-                        &outMat->data[3],
-                        &outMat->data[4],
-                        &outMat->data[5],
-                        &outMat->data[6],
-                        &outMat->data[7],
-                        &outMat->data[8],
-                        &outMat->data[9],
-                        &outMat->data[10],
-                        &outMat->data[11],
-                        &outMat->data[12],
-                        &outMat->data[13],
-                        &outMat->data[14],
-                        &outMat->data[15]);
-    return result != -1;
+    return strToFloats(str, outMat->data, 16);
 }
 
 b8 strToVec4(const char* str, vector4* outVector) {
     if (!str || !outVector) {
         return false;
     }
-
-    fzeroMemory(outVector, sizeof(vector4));
-    i32 result = sscanf(str, "%f %f %f %f", &outVector->x, &outVector->y, &outVector->z, &outVector->w);
-    return result != -1;
+    return strToFloats(str, &outVector->x, 4);
 }
 
 b8 strToVec3(const char* str, vector3* outVector) {
     if (!str || !outVector) {
         return false;
     }
-
-    fzeroMemory(outVector, sizeof(vector3));
-    i32 result = sscanf(str, "%f %f %f", &outVector->x, &outVector->y, &outVector->z);
-    return result != -1;
+    return strToFloats(str, &outVector->x, 3);
 }
 
 b8 strToVec2(const char* str, vector2* outVector) {
     if (!str || !outVector) {
         return false;
     }
-
-    fzeroMemory(outVector, sizeof(vector2));
-    i32 result = sscanf(str, "%f %f", &outVector->x, &outVector->y);
-    return result != -1;
+    return strToFloats(str, &outVector->x, 2);
 }
 
 b8 strToF32(const char* str, f32* f) {
@@ -283,8 +763,8 @@ b8 strToF32(const char* str, f32* f) {
     }
 
     *f = 0;
-    i32 result = sscanf(str, "%f", f);
-    return result != -1;
+    strView v = strViewFromCStr(str);
+    return strViewParseF32(&v, f);
 }
 
 b8 strToF64(const char* str, f64* f) {
@@ -293,8 +773,29 @@ b8 strToF64(const char* str, f64* f) {
     }
 
     *f = 0;
-    i32 result = sscanf(str, "%lf", f);
-    return result != -1;
+    strView v = strViewFromCStr(str);
+    return strViewParseF64(&v, f);
+}
+
+// Parses a signed number and makes sure it fits in [min, max]
+static b8 strToSigned(const char* str, i64 min, i64 max, i64* out) {
+    strView v = strViewFromCStr(str);
+    i64 value;
+    if (!strViewParseI64(&v, &value) || value < min || value > max) {
+        return false;
+    }
+    *out = value;
+    return true;
+}
+
+static b8 strToUnsigned(const char* str, u64 max, u64* out) {
+    strView v = strViewFromCStr(str);
+    u64 value;
+    if (!strViewParseU64(&v, &value) || value > max) {
+        return false;
+    }
+    *out = value;
+    return true;
 }
 
 b8 strToI8(const char* str, i8* i) {
@@ -303,8 +804,12 @@ b8 strToI8(const char* str, i8* i) {
     }
 
     *i = 0;
-    i32 result = sscanf(str, "%hhi", i);
-    return result != -1;
+    i64 v;
+    if (!strToSigned(str, -128, 127, &v)) {
+        return false;
+    }
+    *i = (i8)v;
+    return true;
 }
 
 b8 strToI16(const char* str, i16* i) {
@@ -313,8 +818,12 @@ b8 strToI16(const char* str, i16* i) {
     }
 
     *i = 0;
-    i32 result = sscanf(str, "%hi", i);
-    return result != -1;
+    i64 v;
+    if (!strToSigned(str, -32768, 32767, &v)) {
+        return false;
+    }
+    *i = (i16)v;
+    return true;
 }
 
 b8 strToI32(const char* str, i32* i) {
@@ -323,8 +832,12 @@ b8 strToI32(const char* str, i32* i) {
     }
 
     *i = 0;
-    i32 result = sscanf(str, "%i", i);
-    return result != -1;
+    i64 v;
+    if (!strToSigned(str, -2147483647 - 1, 2147483647, &v)) {
+        return false;
+    }
+    *i = (i32)v;
+    return true;
 }
 
 b8 strToI64(const char* str, i64* i) {
@@ -333,8 +846,8 @@ b8 strToI64(const char* str, i64* i) {
     }
 
     *i = 0;
-    i32 result = sscanf(str, "%lli", i);
-    return result != -1;
+    strView v = strViewFromCStr(str);
+    return strViewParseI64(&v, i);
 }
 
 b8 strToU8(const char* str, u8* u) {
@@ -343,8 +856,12 @@ b8 strToU8(const char* str, u8* u) {
     }
 
     *u = 0;
-    i32 result = sscanf(str, "%hhu", u);
-    return result != -1;
+    u64 v;
+    if (!strToUnsigned(str, 0xFF, &v)) {
+        return false;
+    }
+    *u = (u8)v;
+    return true;
 }
 
 b8 strToU16(const char* str, u16* u) {
@@ -353,8 +870,12 @@ b8 strToU16(const char* str, u16* u) {
     }
 
     *u = 0;
-    i32 result = sscanf(str, "%hu", u);
-    return result != -1;
+    u64 v;
+    if (!strToUnsigned(str, 0xFFFF, &v)) {
+        return false;
+    }
+    *u = (u16)v;
+    return true;
 }
 
 b8 strToU32(const char* str, u32* u) {
@@ -363,8 +884,12 @@ b8 strToU32(const char* str, u32* u) {
     }
 
     *u = 0;
-    i32 result = sscanf(str, "%u", u);
-    return result != -1;
+    u64 v;
+    if (!strToUnsigned(str, 0xFFFFFFFF, &v)) {
+        return false;
+    }
+    *u = (u32)v;
+    return true;
 }
 
 b8 strToU64(const char* str, u64* u) {
@@ -373,8 +898,8 @@ b8 strToU64(const char* str, u64* u) {
     }
 
     *u = 0;
-    i32 result = sscanf(str, "%llu", u);
-    return result != -1;
+    strView v = strViewFromCStr(str);
+    return strViewParseU64(&v, u);
 }
 
 b8 strToBool(const char* str, b8* b) {
@@ -3,6 +3,15 @@
 #include "defines.h"
 #include "math/matrixMath.h"
 
+/**
+ * @brief A non-owning view into a string. Not null terminated, always use len.
+ * Views are only valid as long as the string they point into.
+ */
+typedef struct strView {
+    const char* ptr;
+    u64 len;
+} strView;
+
 // Returns the length of the given str.
 CT_API u64 strLen(const char* str);
 
@@ -43,6 +52,94 @@ CT_API void strCleanDinoArray(char** a);
 
 CT_API i32 strIdxOf(const char* str, char c);
 
+//====================== String Views ======================
+
+CT_API strView strViewFromCStr(const char* str);
+
+CT_API strView strViewMake(const char* ptr, u64 len);
+
+/**
+ * @brief If a negative length is passed, proceed to the end of the view.
+ */
+CT_API strView strViewSub(strView v, u64 start, i64 length);
+
+/**
+ * @brief Allocates a null terminated copy of the view. Free it like any other
+ * strDup'd string.
+ */
+CT_API char* strViewDup(strView v);
+
+/**
+ * @brief Copies the view into dest and null terminates it. Copies at most
+ * destSize - 1 characters.
+ * @returns The amount of characters copied.
+ */
+CT_API u64 strViewCopy(char* dest, strView v, u64 destSize);
+
+CT_API strView strTrimView(strView v);
+
+CT_API i64 strIdxOfView(strView v, char c);
+
+CT_API b8 strViewEqual(strView v0, strView v1);
+
+CT_API b8 strViewEqualI(strView v0, strView v1);
+
+CT_API b8 strViewEqualCStr(strView v, const char* str);
+
+CT_API b8 strViewEqualICStr(strView v, const char* str);
+
+/**
+ * @brief Pops the next field off of remaining. Nothing is copied or allocated.
+ * @param remaining The view left to split. Updated to point after the field.
+ * @param delimeter The character that separates fields
+ * @param outToken The field that was split off (untrimmed)
+ * @returns false once every field has been returned.
+ */
+CT_API b8 strSplitViewNext(strView* remaining, char delimeter,
+                           strView* outToken);
+
+/**
+ * @brief Same as `strSplit` except the fields are views into str. Nothing is
+ * copied or allocated.
+ * @param outViews Caller owned array the fields are written to
+ * @param maxViews Size of outViews. Fields past this are dropped.
+ * @returns The amount of fields written to outViews
+ */
+CT_API u32 strSplitView(strView str, char delimeter, strView* outViews,
+                        u32 maxViews, b8 trimIt, b8 includeZeroCharLines);
+
+//====================== Number Parsing ======================
+
+/**
+ * @brief Parses a number from the start of v, skipping leading whitespace.
+ * Locale independent and doesn't allocate. On success v is advanced past the
+ * number so calls can be chained to walk a list.
+ * @returns false if no number was found or it doesn't fit.
+ */
+CT_API b8 strViewParseF32(strView* v, f32* f);
+
+CT_API b8 strViewParseF64(strView* v, f64* f);
+
+/**
+ * @brief Same as `strViewParseF32`. Accepts 0x (hex) and leading 0 (octal)
+ * prefixes like scanf's %i.
+ */
+CT_API b8 strViewParseI64(strView* v, i64* i);
+
+CT_API b8 strViewParseU64(strView* v, u64* u);
+
+/**
+ * @brief Parses up to maxCnt floats separated by whitespace and/or commas in
+ * a single pass.
+ * @returns The amount of floats written to outValues
+ */
+CT_API u32 strViewParseF32List(strView v, f32* outValues, u32 maxCnt);
+
+/**
+ * @brief The strTo* functions below return false if str doesn't start with a
+ * number or the number doesn't fit. Vector/matrix versions need every
+ * component.
+ */
 CT_API b8 strToMat4(const char* str, mat4* outMat);
 
 CT_API b8 strToVec4(const char* str, vector4* outVector);
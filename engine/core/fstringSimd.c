@@ -0,0 +1,329 @@
+#include "core/fstringSimd.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define FSN_STR_SIMD 1
+#include <emmintrin.h> // SSE2
+#include <immintrin.h> // AVX2
+#ifdef _MSC_VER
+#include <intrin.h>
+#define FSN_TARGET_AVX2
+#else
+#define FSN_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#else
+#define FSN_STR_SIMD 0
+#endif
+
+/*
+ * Every kernel has a scalar version which is also used for the tails the
+ * vector loops can't cover. The vector loops never read past `len`, except
+ * strLen which only does aligned loads so it can't cross into an unmapped page.
+ * The AVX2 kernels hand their tails to the SSE2 ones, so they have to clear
+ * the upper halves first or every call eats an AVX/SSE transition stall.
+ */
+
+FSN_INLINE b8 isSpace(char c) {
+    // Same set as isspace in the C locale: ' ', \t, \n, \v, \f, \r
+    return c == ' ' || (u8)(c - '\t') <= 4;
+}
+
+FSN_INLINE char toLower(char c) {
+    return ((u8)(c - 'A') <= 25) ? c | 0x20 : c;
+}
+
+//====================== Scalar ======================
+
+static u64 scalarLen(const char* str) {
+    const char* p = str;
+    while (*p) {
+        p++;
+    }
+    return p - str;
+}
+
+static i64 scalarFindChar(const char* str, u64 len, char c) {
+    for (u64 i = 0; i < len; i++) {
+        if (str[i] == c) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static u64 scalarSkipSpace(const char* str, u64 len) {
+    u64 i = 0;
+    while (i < len && isSpace(str[i])) {
+        i++;
+    }
+    return i;
+}
+
+static u64 scalarSkipSpaceRev(const char* str, u64 len) {
+    u64 i = 0;
+    while (i < len && isSpace(str[len - 1 - i])) {
+        i++;
+    }
+    return i;
+}
+
+static b8 scalarEqualI(const char* str0, const char* str1, u64 len) {
+    for (u64 i = 0; i < len; i++) {
+        if (toLower(str0[i]) != toLower(str1[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+strKernels strKernel = {scalarLen, scalarFindChar, scalarSkipSpace,
+                        scalarSkipSpaceRev, scalarEqualI};
+
+static const char* kernelName = "scalar";
+
+#if FSN_STR_SIMD
+
+FSN_INLINE u32 lowestBit(u32 mask) {
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanForward(&idx, mask);
+    return idx;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+FSN_INLINE u32 highestBit(u32 mask) {
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanReverse(&idx, mask);
+    return idx;
+#else
+    return 31 - __builtin_clz(mask);
+#endif
+}
+
+//====================== SSE2 ======================
+
+// 0xFF for every whitespace byte
+FSN_INLINE __m128i sse2SpaceMask(__m128i v) {
+    __m128i shifted = _mm_sub_epi8(v, _mm_set1_epi8('\t'));
+    __m128i inRange =
+        _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(4)), shifted);
+    return _mm_or_si128(inRange, _mm_cmpeq_epi8(v, _mm_set1_epi8(' ')));
+}
+
+FSN_INLINE __m128i sse2ToLower(__m128i v) {
+    __m128i shifted = _mm_sub_epi8(v, _mm_set1_epi8('A'));
+    __m128i isUpper =
+        _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(25)), shifted);
+    return _mm_or_si128(v, _mm_and_si128(isUpper, _mm_set1_epi8(0x20)));
+}
+
+static u64 sse2Len(const char* str) {
+    // Align down so no load can cross a page boundary, then ignore the bytes
+    // before str.
+    u64 misalign = (u64)str & 15;
+    const __m128i* p = (const __m128i*)(str - misalign);
+    const __m128i zero = _mm_setzero_si128();
+    u32 mask = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128(p), zero));
+    mask >>= misalign;
+    if (mask) {
+        return lowestBit(mask);
+    }
+    for (;;) {
+        p++;
+        mask = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128(p), zero));
+        if (mask) {
+            return ((const char*)p - str) + lowestBit(mask);
+        }
+    }
+}
+
+static i64 sse2FindChar(const char* str, u64 len, char c) {
+    const __m128i needle = _mm_set1_epi8(c);
+    u64 i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(str + i));
+        u32 mask = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(v, needle));
+        if (mask) {
+            return i + lowestBit(mask);
+        }
+    }
+    i64 tail = scalarFindChar(str + i, len - i, c);
+    return tail == -1 ? -1 : (i64)i + tail;
+}
+
+static u64 sse2SkipSpace(const char* str, u64 len) {
+    u64 i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(str + i));
+        u32 notSpace = ~(u32)_mm_movemask_epi8(sse2SpaceMask(v)) & 0xFFFF;
+        if (notSpace) {
+            return i + lowestBit(notSpace);
+        }
+    }
+    return i + scalarSkipSpace(str + i, len - i);
+}
+
+static u64 sse2SkipSpaceRev(const char* str, u64 len) {
+    u64 end = len;
+    for (; end >= 16; end -= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(str + end - 16));
+        u32 notSpace = ~(u32)_mm_movemask_epi8(sse2SpaceMask(v)) & 0xFFFF;
+        if (notSpace) {
+            return (len - end) + (15 - highestBit(notSpace));
+        }
+    }
+    return (len - end) + scalarSkipSpaceRev(str, end);
+}
+
+static b8 sse2EqualI(const char* str0, const char* str1, u64 len) {
+    u64 i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i a = sse2ToLower(_mm_loadu_si128((const __m128i*)(str0 + i)));
+        __m128i b = sse2ToLower(_mm_loadu_si128((const __m128i*)(str1 + i)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) != 0xFFFF) {
+            return false;
+        }
+    }
+    return scalarEqualI(str0 + i, str1 + i, len - i);
+}
+
+//====================== AVX2 ======================
+
+FSN_TARGET_AVX2 FSN_INLINE __m256i avx2SpaceMask(__m256i v) {
+    __m256i shifted = _mm256_sub_epi8(v, _mm256_set1_epi8('\t'));
+    __m256i inRange = _mm256_cmpeq_epi8(
+        _mm256_min_epu8(shifted, _mm256_set1_epi8(4)), shifted);
+    return _mm256_or_si256(inRange,
+                           _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')));
+}
+
+FSN_TARGET_AVX2 FSN_INLINE __m256i avx2ToLower(__m256i v) {
+    __m256i shifted = _mm256_sub_epi8(v, _mm256_set1_epi8('A'));
+    __m256i isUpper = _mm256_cmpeq_epi8(
+        _mm256_min_epu8(shifted, _mm256_set1_epi8(25)), shifted);
+    return _mm256_or_si256(v,
+                           _mm256_and_si256(isUpper, _mm256_set1_epi8(0x20)));
+}
+
+FSN_TARGET_AVX2 static u64 avx2Len(const char* str) {
+    u64 misalign = (u64)str & 31;
+    const __m256i* p = (const __m256i*)(str - misalign);
+    const __m256i zero = _mm256_setzero_si256();
+    u32 mask = (u32)_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_load_si256(p), zero));
+    mask >>= misalign;
+    if (mask) {
+        return lowestBit(mask);
+    }
+    for (;;) {
+        p++;
+        mask = (u32)_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_load_si256(p), zero));
+        if (mask) {
+            return ((const char*)p - str) + lowestBit(mask);
+        }
+    }
+}
+
+FSN_TARGET_AVX2 static i64 avx2FindChar(const char* str, u64 len, char c) {
+    const __m256i needle = _mm256_set1_epi8(c);
+    u64 i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(str + i));
+        u32 mask = (u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, needle));
+        if (mask) {
+            return i + lowestBit(mask);
+        }
+    }
+    _mm256_zeroupper();
+    i64 tail = sse2FindChar(str + i, len - i, c);
+    return tail == -1 ? -1 : (i64)i + tail;
+}
+
+FSN_TARGET_AVX2 static u64 avx2SkipSpace(const char* str, u64 len) {
+    u64 i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(str + i));
+        u32 notSpace = ~(u32)_mm256_movemask_epi8(avx2SpaceMask(v));
+        if (notSpace) {
+            return i + lowestBit(notSpace);
+        }
+    }
+    _mm256_zeroupper();
+    return i + sse2SkipSpace(str + i, len - i);
+}
+
+FSN_TARGET_AVX2 static u64 avx2SkipSpaceRev(const char* str, u64 len) {
+    u64 end = len;
+    for (; end >= 32; end -= 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(str + end - 32));
+        u32 notSpace = ~(u32)_mm256_movemask_epi8(avx2SpaceMask(v));
+        if (notSpace) {
+            return (len - end) + (31 - highestBit(notSpace));
+        }
+    }
+    _mm256_zeroupper();
+    return (len - end) + sse2SkipSpaceRev(str, end);
+}
+
+FSN_TARGET_AVX2 static b8 avx2EqualI(const char* str0, const char* str1,
+                                     u64 len) {
+    u64 i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i a =
+            avx2ToLower(_mm256_loadu_si256((const __m256i*)(str0 + i)));
+        __m256i b =
+            avx2ToLower(_mm256_loadu_si256((const __m256i*)(str1 + i)));
+        if ((u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)) !=
+            0xFFFFFFFF) {
+            return false;
+        }
+    }
+    _mm256_zeroupper();
+    return sse2EqualI(str0 + i, str1 + i, len - i);
+}
+
+static b8 cpuHasAvx2() {
+#ifdef _MSC_VER
+    i32 info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    // OSXSAVE and AVX, then make sure the OS saves the ymm registers
+    b8 osxsave = (info[2] & (1 << 27)) != 0;
+    b8 avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // FSN_STR_SIMD
+
+void strSimdInit() {
+#if FSN_STR_SIMD
+    if (cpuHasAvx2()) {
+        strKernel = (strKernels){avx2Len, avx2FindChar, avx2SkipSpace,
+                                 avx2SkipSpaceRev, avx2EqualI};
+        kernelName = "avx2";
+    } else {
+        // SSE2 is always there on x86_64
+        strKernel = (strKernels){sse2Len, sse2FindChar, sse2SkipSpace,
+                                 sse2SkipSpaceRev, sse2EqualI};
+        kernelName = "sse2";
+    }
+#endif
+}
+
+const char* strSimdName() {
+    return kernelName;
+}
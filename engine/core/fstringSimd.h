@@ -0,0 +1,36 @@
+#pragma once
+
+#include "defines.h"
+
+/**
+ * Kernels used by fstring for the hot byte scanning loops. `strKernel` starts
+ * out pointing at the scalar versions so fstring works before
+ * `strSimdInit` is called. strSimdInit swaps in the best set the CPU supports.
+ * Only fstring should need to include this.
+ */
+
+typedef struct strKernels {
+    // Length of a null terminated string
+    u64 (*len)(const char* str);
+    // Index of the first c in str[0..len) or -1
+    i64 (*findChar)(const char* str, u64 len, char c);
+    // Amount of leading whitespace in str[0..len)
+    u64 (*skipSpace)(const char* str, u64 len);
+    // Amount of trailing whitespace in str[0..len)
+    u64 (*skipSpaceRev)(const char* str, u64 len);
+    // ASCII case-insensitive compare of two len long strings
+    b8 (*equalI)(const char* str0, const char* str1, u64 len);
+} strKernels;
+
+extern strKernels strKernel;
+
+/**
+ * @brief Detects the CPU features and selects the string kernels. Call once at
+ * startup before any threads are created.
+ */
+CT_API void strSimdInit();
+
+/**
+ * @brief Name of the kernel set in use. ("scalar", "sse2", "avx2")
+ */
+CT_API const char* strSimdName();
@@ -1,42 +1,95 @@
 #include "core/input.h"
 #include "core/fmemory.h"
 #include "core/event.h"
+#include "core/inputLatency.h"
+#include "core/inputRecord.h"
 #include "core/logger.h"
 
-typedef struct keyState {
-    b8 isDown;
-} keyState;
-
-typedef struct keyboardState {
-    keyState keys[256];
-} keyboardState;
-
-typedef struct buttonState {
-    b8 isDown;
-} buttonState;
+#if defined(__x86_64__) || defined(_M_X64)
+#define FSN_INPUT_SIMD 1
+#include <emmintrin.h> // SSE2
+#else
+#define FSN_INPUT_SIMD 0
+#endif
 
 typedef struct mouseState {
     i16 x;
     i16 y;
-    buttonState buttons[BUTTON_MAX_BUTTONS];
+    // Bit per button
+    u32 buttons;
 } mouseState;
 
 typedef struct inputState {
-    keyboardState keyboardCur;
-    keyboardState keyboardPrev;
+    // Bit per key
+    inputKeyMask keysCur;
+    inputKeyMask keysPrev;
     mouseState mouseCur;
     mouseState mousePrev;
+    // When each key/button last went down or came up
+    f64 keyTimes[INPUT_MAX_KEYS];
+    f64 buttonTimes[BUTTON_MAX_BUTTONS];
 } inputState;
 
 static b8 isInit = false;
 static inputState* systemPtr;
 
+FSN_INLINE b8 maskTest(const inputKeyMask* mask, u32 key) {
+    return (mask->bits[(key >> 6) & 3] >> (key & 63)) & 1;
+}
+
+FSN_INLINE void maskSet(inputKeyMask* mask, u32 key, b8 value) {
+    u64 bit = 1ull << (key & 63);
+    if (value) {
+        mask->bits[key >> 6] |= bit;
+    } else {
+        mask->bits[key >> 6] &= ~bit;
+    }
+}
+
+// out = a & ~b & filter, for all 256 bits. Returns true if any bit is set.
+// filter can be 0 for all keys, out can be 0 if only the answer matters.
+static b8 maskAndNot(const inputKeyMask* a, const inputKeyMask* b, const inputKeyMask* filter, inputKeyMask* out) {
+#if FSN_INPUT_SIMD == 1
+    __m128i lo = _mm_andnot_si128(_mm_loadu_si128((const __m128i*)&b->bits[0]),
+                                  _mm_loadu_si128((const __m128i*)&a->bits[0]));
+    __m128i hi = _mm_andnot_si128(_mm_loadu_si128((const __m128i*)&b->bits[2]),
+                                  _mm_loadu_si128((const __m128i*)&a->bits[2]));
+    if (filter) {
+        lo = _mm_and_si128(lo, _mm_loadu_si128((const __m128i*)&filter->bits[0]));
+        hi = _mm_and_si128(hi, _mm_loadu_si128((const __m128i*)&filter->bits[2]));
+    }
+    if (out) {
+        _mm_storeu_si128((__m128i*)&out->bits[0], lo);
+        _mm_storeu_si128((__m128i*)&out->bits[2], hi);
+    }
+    __m128i any = _mm_or_si128(lo, hi);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(any, _mm_setzero_si128())) != 0xFFFF;
+#else
+    u64 any = 0;
+    for (u32 i = 0; i < 4; i++) {
+        u64 bits = a->bits[i] & ~b->bits[i];
+        if (filter) {
+            bits &= filter->bits[i];
+        }
+        if (out) {
+            out->bits[i] = bits;
+        }
+        any |= bits;
+    }
+    return any != 0;
+#endif
+}
+
+// Mask with no bits set, so "a & ~none" is just a.
+static const inputKeyMask noKeys = {{0, 0, 0, 0}};
+
 void inputInit(u64* memoryRequirement, void* state){
     *memoryRequirement = sizeof(inputState);
     if (state == 0){
         return;
     }
     systemPtr = state;
+    fzeroMemory(systemPtr, sizeof(inputState));
     isInit = true;
 
     FINFO("Input system inited");
@@ -45,104 +98,138 @@ void inputInit(u64* memoryRequirement, void* state){
 void inputUpdate(f64 deltaTime){
     if (!isInit){
         FERROR("Input system is not inited");
+        return;
     }
 
-    fcopyMemory(&systemPtr->keyboardPrev,&systemPtr->keyboardCur,sizeof(keyboardState));
-    fcopyMemory(&systemPtr->mousePrev,&systemPtr->mouseCur,sizeof(mouseState));
+    systemPtr->keysPrev = systemPtr->keysCur;
+    systemPtr->mousePrev = systemPtr->mouseCur;
 }
 
 void inputShutdown(void* state) {
     // TODO: Add shutdown routines when needed.
     systemPtr = 0;
+    isInit = false;
 }
 
-void inputProcessKey(keys key, b8 pressed) {
-    eventContext context;
+void inputProcessKey(keys key, b8 pressed, f64 timestamp) {
+    // Live input is ignored while a recording plays back.
+    if (inputReplayBlocksLive() || (u32)key >= INPUT_MAX_KEYS) {
+        return;
+    }
+    inputRecordKey(key, pressed);
+    inputLatencyOnInput(timestamp);
+
+    eventContext context = {0};
     context.data.u16[0] = key;
-    systemPtr->keyboardCur.keys[key].isDown = pressed;
+    if (pressed != maskTest(&systemPtr->keysCur, key)) {
+        systemPtr->keyTimes[key] = timestamp;
+    }
+    maskSet(&systemPtr->keysCur, key, pressed);
 
-    if (systemPtr->keyboardCur.keys[key].isDown != systemPtr->keyboardPrev.keys[key].isDown) {
-        // Fire off an event for immediate processing.
-        eventFire(pressed ? EVENT_CODE_KEY_PRESSED : EVENT_CODE_KEY_RELEASED, 0, context);
+    if (pressed != maskTest(&systemPtr->keysPrev, key)) {
+        // Queue it up for this frame's dispatch.
+        eventPost(pressed ? EVENT_CODE_KEY_PRESSED : EVENT_CODE_KEY_RELEASED, 0, context);
     }else{
-        eventFire(EVENT_CODE_KEY_DOWN, 0, context);
+        eventPost(EVENT_CODE_KEY_DOWN, 0, context);
     }
 }
 
-void inputProcessButton(buttons button, b8 pressed) {
-    eventContext context;
+void inputProcessButton(buttons button, b8 pressed, f64 timestamp) {
+    if (inputReplayBlocksLive() || (u32)button >= BUTTON_MAX_BUTTONS) {
+        return;
+    }
+    inputRecordButton(button, pressed);
+    inputLatencyOnInput(timestamp);
+
+    eventContext context = {0};
     context.data.u16[0] = button;
-    systemPtr->mouseCur.buttons[button].isDown = pressed;
-    if (systemPtr->mouseCur.buttons[button].isDown != systemPtr->mousePrev.buttons[button].isDown){
-        // Fire the event.
-        eventFire(pressed ? EVENT_CODE_BUTTON_PRESSED : EVENT_CODE_BUTTON_RELEASED, 0, context);
+    u32 bit = 1u << button;
+    if (pressed != ((systemPtr->mouseCur.buttons & bit) != 0)) {
+        systemPtr->buttonTimes[button] = timestamp;
+    }
+    systemPtr->mouseCur.buttons = pressed ? systemPtr->mouseCur.buttons | bit : systemPtr->mouseCur.buttons & ~bit;
+    if (pressed != ((systemPtr->mousePrev.buttons & bit) != 0)){
+        // Post the event.
+        eventPost(pressed ? EVENT_CODE_BUTTON_PRESSED : EVENT_CODE_BUTTON_RELEASED, 0, context);
     }else{
-        eventFire(EVENT_CODE_BUTTON_DOWN, 0, context);
+        eventPost(EVENT_CODE_BUTTON_DOWN, 0, context);
     }
 }
 
-void inputProcessMouseMove(i16 x, i16 y) {
+void inputProcessMouseMove(i16 x, i16 y, f64 timestamp) {
+    if (inputReplayBlocksLive()) {
+        return;
+    }
+    inputRecordMouseMove(x, y);
+    inputLatencyOnInput(timestamp);
+
     // Only process if actually different
     if (systemPtr->mouseCur.x != x || systemPtr->mouseCur.y != y) {
         // Update internal systemPtr->
         systemPtr->mouseCur.x = x;
         systemPtr->mouseCur.y = y;
 
-        // Fire the event.
-        eventContext context;
+        // Post the event.
+        eventContext context = {0};
         context.data.u16[0] = x;
         context.data.u16[1] = y;
-        eventFire(EVENT_CODE_MOUSE_MOVED, 0, context);
+        eventPost(EVENT_CODE_MOUSE_MOVED, 0, context);
     }
 }
 
-void inputProcessMouseWheel(i8 zDelta) {
-    // Fire the event.
-    eventContext context;
+void inputProcessMouseWheel(i8 zDelta, f64 timestamp) {
+    if (inputReplayBlocksLive()) {
+        return;
+    }
+    inputRecordMouseWheel(zDelta);
+    inputLatencyOnInput(timestamp);
+
+    // Post the event.
+    eventContext context = {0};
     context.data.u8[0] = zDelta;
-    eventFire(EVENT_CODE_MOUSE_WHEEL, 0, context);
+    eventPost(EVENT_CODE_MOUSE_WHEEL, 0, context);
 }
 
 b8 inputIsKeyDown(keys key) {
     if (!isInit) {
         return false;
     }
-    return systemPtr->keyboardCur.keys[key].isDown;
+    return maskTest(&systemPtr->keysCur, key);
 }
 
 b8 inputIsKeyUp(keys key) {
     if (!isInit) {
         return true;
     }
-    return !systemPtr->keyboardCur.keys[key].isDown;
+    return !maskTest(&systemPtr->keysCur, key);
 }
 
 b8 inputIsKeyReleased(keys key) {
     if (!isInit) {
         return false;
     }
-    return ((systemPtr->keyboardPrev.keys[key].isDown != systemPtr->keyboardCur.keys[key].isDown) && !systemPtr->keyboardCur.keys[key].isDown);
+    return ((maskTest(&systemPtr->keysPrev, key) != maskTest(&systemPtr->keysCur, key)) && !maskTest(&systemPtr->keysCur, key));
 }
 
 b8 inputIsKeyPressed(keys key) {
     if (!isInit) {
         return false;
     }
-    return ((systemPtr->keyboardPrev.keys[key].isDown != systemPtr->keyboardCur.keys[key].isDown) && systemPtr->keyboardCur.keys[key].isDown);
+    return ((maskTest(&systemPtr->keysPrev, key) != maskTest(&systemPtr->keysCur, key)) && maskTest(&systemPtr->keysCur, key));
 }
 
 b8 inputWasKeyPressed(keys key) {
     if (!isInit) {
         return false;
     }
-    return systemPtr->keyboardPrev.keys[key].isDown;
+    return maskTest(&systemPtr->keysPrev, key);
 }
 
 b8 inputWasKeyUp(keys key) {
     if (!isInit) {
         return true;
     }
-    return !systemPtr->keyboardPrev.keys[key].isDown;
+    return !maskTest(&systemPtr->keysPrev, key);
 }
 
 // mouse input
@@ -150,14 +237,14 @@ b8 inputIsButtonPressed(buttons button) {
     if (!isInit) {
         return false;
     }
-    return ((systemPtr->mouseCur.buttons[button].isDown != systemPtr->mousePrev.buttons[button].isDown) && systemPtr->mouseCur.buttons[button].isDown);
+    return ((((systemPtr->mouseCur.buttons >> button) & 1) != ((systemPtr->mousePrev.buttons >> button) & 1)) && ((systemPtr->mouseCur.buttons >> button) & 1));
 }
 
 b8 inputIsButtonReleased(buttons button){
     if (!isInit) {
         return false;
     }
-    return ((systemPtr->mouseCur.buttons[button].isDown != systemPtr->mousePrev.buttons[button].isDown) && !systemPtr->mouseCur.buttons[button].isDown);
+    return ((((systemPtr->mouseCur.buttons >> button) & 1) != ((systemPtr->mousePrev.buttons >> button) & 1)) && !((systemPtr->mouseCur.buttons >> button) & 1));
 }
 
 
@@ -165,28 +252,28 @@ b8 inputIsButtonUp(buttons button) {
     if (!isInit) {
         return true;
     }
-    return !systemPtr->mouseCur.buttons[button].isDown;
+    return !((systemPtr->mouseCur.buttons >> button) & 1);
 }
 
 b8 inputIsButtonDown(buttons button){
     if (!isInit) {
         return true;
     }
-    return systemPtr->mouseCur.buttons[button].isDown;
+    return ((systemPtr->mouseCur.buttons >> button) & 1);
 }
 
 b8 inputWasButtonPressed(buttons button) {
     if (!isInit) {
         return false;
     }
-    return systemPtr->mousePrev.buttons[button].isDown;
+    return ((systemPtr->mousePrev.buttons >> button) & 1);
 }
 
 b8 inputWasButtonUp(buttons button) {
     if (!isInit) {
         return true;
     }
-    return !systemPtr->mousePrev.buttons[button].isDown;
+    return !((systemPtr->mousePrev.buttons >> button) & 1);
 }
 
 void inputGetMousePosition(i32* x, i32* y) {
@@ -208,3 +295,48 @@ void inputGetPreviousMousePosition(i32* x, i32* y) {
     *x = systemPtr->mousePrev.x;
     *y = systemPtr->mousePrev.y;
 }
+
+void inputGetKeyEdges(inputKeyMask* outPressed, inputKeyMask* outReleased) {
+    if (!isInit) {
+        fzeroMemory(outPressed, sizeof(inputKeyMask));
+        fzeroMemory(outReleased, sizeof(inputKeyMask));
+        return;
+    }
+    maskAndNot(&systemPtr->keysCur, &systemPtr->keysPrev, 0, outPressed);
+    maskAndNot(&systemPtr->keysPrev, &systemPtr->keysCur, 0, outReleased);
+}
+
+b8 inputAnyKeyDown(const inputKeyMask* mask) {
+    if (!isInit) {
+        return false;
+    }
+    return maskAndNot(&systemPtr->keysCur, &noKeys, mask, 0);
+}
+
+b8 inputAnyKeyPressed(const inputKeyMask* mask) {
+    if (!isInit) {
+        return false;
+    }
+    return maskAndNot(&systemPtr->keysCur, &systemPtr->keysPrev, mask, 0);
+}
+
+b8 inputAnyKeyReleased(const inputKeyMask* mask) {
+    if (!isInit) {
+        return false;
+    }
+    return maskAndNot(&systemPtr->keysPrev, &systemPtr->keysCur, mask, 0);
+}
+
+f64 inputGetKeyTimestamp(keys key) {
+    if (!isInit || (u32)key >= INPUT_MAX_KEYS) {
+        return 0;
+    }
+    return systemPtr->keyTimes[key];
+}
+
+f64 inputGetButtonTimestamp(buttons button) {
+    if (!isInit || (u32)button >= BUTTON_MAX_BUTTONS) {
+        return 0;
+    }
+    return systemPtr->buttonTimes[button];
+}
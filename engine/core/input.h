@@ -142,6 +142,24 @@ typedef enum keys {
     KEYS_MAX_KEYS
 } keys;
 
+#define INPUT_MAX_KEYS 256
+
+/**
+ * @brief One bit per key code, for testing many keys at once. Build one with
+ * inputKeyMaskAdd, e.g. every key bound to an action.
+ */
+typedef struct inputKeyMask {
+    u64 bits[INPUT_MAX_KEYS / 64];
+} inputKeyMask;
+
+FSN_INLINE void inputKeyMaskAdd(inputKeyMask* mask, keys key) {
+    mask->bits[(key >> 6) & 3] |= 1ull << (key & 63);
+}
+
+FSN_INLINE b8 inputKeyMaskHas(const inputKeyMask* mask, keys key) {
+    return (mask->bits[(key >> 6) & 3] >> (key & 63)) & 1;
+}
+
 void inputInit(u64* memoryRequirement, void* state);
 void inputUpdate(f64 deltaTime);
 void inputShutdown(void* state);
@@ -156,7 +174,40 @@ CT_API b8 inputWasKeyUp(keys key);
 CT_API b8 inputIsKeyReleased(keys key);
 CT_API b8 inputIsKeyPressed(keys key);
 
-void inputProcessKey(keys key, b8 pressed);
+/**
+ * @brief Hands the input system a key change. Called by the platform layer.
+ * @param timestamp When the OS got it, on platformGetAbsoluteTime's clock
+ */
+void inputProcessKey(keys key, b8 pressed, f64 timestamp);
+
+/**
+ * @brief When the key last went down or came up, on platformGetAbsoluteTime's
+ * clock. 0 if it never did.
+ */
+CT_API f64 inputGetKeyTimestamp(keys key);
+
+/**
+ * @brief Fills in which keys went down and which came up since the last
+ * inputUpdate, a bit per key.
+ */
+CT_API void inputGetKeyEdges(inputKeyMask* outPressed, inputKeyMask* outReleased);
+
+/**
+ * @brief True if any key in mask is held down. A mask of 0 checks every key.
+ */
+CT_API b8 inputAnyKeyDown(const inputKeyMask* mask);
+
+/**
+ * @brief True if any key in mask went down since the last inputUpdate. A mask
+ * of 0 checks every key.
+ */
+CT_API b8 inputAnyKeyPressed(const inputKeyMask* mask);
+
+/**
+ * @brief True if any key in mask came up since the last inputUpdate. A mask
+ * of 0 checks every key.
+ */
+CT_API b8 inputAnyKeyReleased(const inputKeyMask* mask);
 
 // mouse input
 CT_API b8 inputIsButtonDown(buttons button);
@@ -168,6 +219,9 @@ CT_API b8 inputWasButtonUp(buttons button);
 CT_API void inputGetMousePosition(i32* x, i32* y);
 CT_API void inputGetPreviousMousePosition(i32* x, i32* y);
 
-void inputProcessButton(buttons button, b8 pressed);
-void inputProcessMouseMove(i16 x, i16 y);
-void inputProcessMouseWheel(i8 zDelta);
+// Same as inputGetKeyTimestamp for mouse buttons
+CT_API f64 inputGetButtonTimestamp(buttons button);
+
+void inputProcessButton(buttons button, b8 pressed, f64 timestamp);
+void inputProcessMouseMove(i16 x, i16 y, f64 timestamp);
+void inputProcessMouseWheel(i8 zDelta, f64 timestamp);
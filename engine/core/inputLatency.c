@@ -0,0 +1,152 @@
+#include "inputLatency.h"
+
+#include "core/fmemory.h"
+#include "core/logger.h"
+#include "platform/platform.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct latencySamples {
+    f32 values[INPUT_LATENCY_SAMPLES];
+    u32 next;
+    u32 count;
+} latencySamples;
+
+typedef struct inputLatencyState {
+    // Inputs no frame has seen yet
+    f64 pending[INPUT_LATENCY_MAX_PENDING];
+    u32 pendingCnt;
+    // Inputs seen by frames that haven't presented yet, oldest frame first
+    f64 observed[INPUT_LATENCY_MAX_PENDING];
+    u32 observedCnt;
+    // How many of observed belong to each of those frames
+    u32 frameInputs[INPUT_LATENCY_MAX_FRAMES];
+    u32 frameCnt;
+    // Inputs of skipped frames, for the next frame observed
+    u32 carried;
+    u64 untracked;
+
+    latencySamples toFrame;
+    latencySamples toPresent;
+    // Sort scratch for the percentiles
+    f32 sorted[INPUT_LATENCY_SAMPLES];
+    f64 lastLog;
+} inputLatencyState;
+
+static inputLatencyState state;
+
+static void addSample(latencySamples* s, f64 seconds) {
+    s->values[s->next] = (f32)(seconds * 1000.0);
+    s->next = (s->next + 1) % INPUT_LATENCY_SAMPLES;
+    if (s->count < INPUT_LATENCY_SAMPLES) {
+        s->count++;
+    }
+}
+
+void inputLatencyOnInput(f64 timestamp) {
+    if (state.pendingCnt == INPUT_LATENCY_MAX_PENDING) {
+        state.untracked++;
+        return;
+    }
+    state.pending[state.pendingCnt++] = timestamp;
+}
+
+void inputLatencyFrameObserved() {
+    f64 now = platformGetAbsoluteTime();
+    u32 count = state.carried;
+    state.carried = 0;
+    for (u32 i = 0; i < state.pendingCnt; i++) {
+        addSample(&state.toFrame, now - state.pending[i]);
+        if (state.observedCnt < INPUT_LATENCY_MAX_PENDING) {
+            state.observed[state.observedCnt++] = state.pending[i];
+            count++;
+        } else {
+            state.untracked++;
+        }
+    }
+    state.pendingCnt = 0;
+
+    if (state.frameCnt < INPUT_LATENCY_MAX_FRAMES) {
+        state.frameInputs[state.frameCnt++] = count;
+    } else {
+        state.frameInputs[state.frameCnt - 1] += count;
+    }
+}
+
+void inputLatencyFramePresented(b8 presented, f64 presentTime) {
+    if (!state.frameCnt) {
+        return;
+    }
+    u32 count = state.frameInputs[0];
+    state.frameCnt--;
+    memmove(state.frameInputs, state.frameInputs + 1, state.frameCnt * sizeof(u32));
+    if (!presented) {
+        // Stay at the front of observed, the next frame to present takes them
+        if (state.frameCnt) {
+            state.frameInputs[0] += count;
+        } else {
+            state.carried += count;
+        }
+        return;
+    }
+
+    for (u32 i = 0; i < count; i++) {
+        addSample(&state.toPresent, presentTime - state.observed[i]);
+    }
+    state.observedCnt -= count;
+    memmove(state.observed, state.observed + count, state.observedCnt * sizeof(f64));
+
+    if (INPUT_LATENCY_LOG_INTERVAL > 0 &&
+        presentTime - state.lastLog >= INPUT_LATENCY_LOG_INTERVAL) {
+        if (state.lastLog != 0) {
+            inputLatencyLogSummary();
+        }
+        state.lastLog = presentTime;
+    }
+}
+
+static int compareF32(const void* a, const void* b) {
+    f32 fa = *(const f32*)a;
+    f32 fb = *(const f32*)b;
+    return (fa > fb) - (fa < fb);
+}
+
+static void percentiles(const latencySamples* s, inputLatencyPercentiles* out) {
+    fzeroMemory(out, sizeof(inputLatencyPercentiles));
+    if (!s->count) {
+        return;
+    }
+    fcopyMemory(state.sorted, s->values, s->count * sizeof(f32));
+    qsort(state.sorted, s->count, sizeof(f32), compareF32);
+    out->p50 = state.sorted[(s->count - 1) * 50 / 100];
+    out->p90 = state.sorted[(s->count - 1) * 90 / 100];
+    out->p99 = state.sorted[(s->count - 1) * 99 / 100];
+    out->max = state.sorted[s->count - 1];
+}
+
+b8 inputLatencyGetStats(inputLatencyStats* outStats) {
+    outStats->samples = state.toPresent.count;
+    outStats->untracked = state.untracked;
+    percentiles(&state.toFrame, &outStats->toFrame);
+    percentiles(&state.toPresent, &outStats->toPresent);
+    return state.toPresent.count != 0;
+}
+
+void inputLatencyLogSummary() {
+    inputLatencyStats stats;
+    if (!inputLatencyGetStats(&stats)) {
+        return;
+    }
+    FINFO("Input latency over %u inputs (ms): to frame p50 %.2f p90 %.2f p99 %.2f max %.2f, "
+          "to present p50 %.2f p90 %.2f p99 %.2f max %.2f, %llu untracked",
+          stats.samples, stats.toFrame.p50, stats.toFrame.p90, stats.toFrame.p99, stats.toFrame.max,
+          stats.toPresent.p50, stats.toPresent.p90, stats.toPresent.p99, stats.toPresent.max,
+          stats.untracked);
+}
+
+void inputLatencyReset() {
+    state.toFrame.count = state.toFrame.next = 0;
+    state.toPresent.count = state.toPresent.next = 0;
+    state.untracked = 0;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "defines.h"
+
+/**
+ *  Input latency tracker. Every input the input system takes is remembered
+ * with its OS timestamp until a frame dispatches it, and then until that
+ * frame is presented. That gives two samples per input:
+ *      toFrame:   timestamp -> the first frame that saw it
+ *      toPresent: timestamp -> that frame's present call
+ * Frames that don't present (swapchain rebuilds) hand their inputs on to the
+ * next one that does. The latest INPUT_LATENCY_SAMPLES of each are kept for
+ * the percentiles.
+ *
+ *  Presents are reported in the order the frames were observed, and with a
+ * render thread they can come in a frame or two late, so each frame's
+ * inputs are kept apart until its own present.
+ */
+
+// Inputs waiting for a frame. Past that the newest ones aren't tracked.
+#define INPUT_LATENCY_MAX_PENDING 512
+// Frames observed but not presented yet. Past that the newest ones share.
+#define INPUT_LATENCY_MAX_FRAMES 4
+// Samples kept for the percentiles
+#define INPUT_LATENCY_SAMPLES 4096
+// Seconds between the summaries logged from inputLatencyFramePresented. 0
+// turns them off.
+#ifndef INPUT_LATENCY_LOG_INTERVAL
+#define INPUT_LATENCY_LOG_INTERVAL 10.0
+#endif
+
+/** @brief Latencies in milliseconds. */
+typedef struct inputLatencyPercentiles {
+    f32 p50;
+    f32 p90;
+    f32 p99;
+    f32 max;
+} inputLatencyPercentiles;
+
+typedef struct inputLatencyStats {
+    /** @brief Samples the percentiles were taken over. */
+    u32 samples;
+    inputLatencyPercentiles toFrame;
+    inputLatencyPercentiles toPresent;
+    /** @brief Inputs that didn't fit in the pending list. */
+    u64 untracked;
+} inputLatencyStats;
+
+/**
+ * @brief Called by the input system for every input it takes.
+ * @param timestamp When the OS got the input, platformGetAbsoluteTime's clock
+ */
+void inputLatencyOnInput(f64 timestamp);
+
+/**
+ * @brief Call once the frame has dispatched this frame's input.
+ */
+CT_API void inputLatencyFrameObserved();
+
+/**
+ * @brief Call once the oldest observed frame's present was submitted.
+ * @param presented false if the frame was skipped, its inputs then count
+ * toward the next present
+ * @param presentTime When the present was submitted, platformGetAbsoluteTime's
+ * clock
+ */
+CT_API void inputLatencyFramePresented(b8 presented, f64 presentTime);
+
+/**
+ * @brief Percentiles over the kept samples.
+ * @returns false if there are no samples yet
+ */
+CT_API b8 inputLatencyGetStats(inputLatencyStats* outStats);
+
+/**
+ * @brief Logs the current percentiles.
+ */
+CT_API void inputLatencyLogSummary();
+
+/**
+ * @brief Throws away every sample.
+ */
+CT_API void inputLatencyReset();
@@ -0,0 +1,236 @@
+#include "inputRecord.h"
+
+#include "core/event.h"
+#include "core/fmemory.h"
+#include "core/input.h"
+#include "core/logger.h"
+#include "platform/filesystem.h"
+#include "platform/platform.h"
+
+#include <string.h>
+
+typedef enum inputRecordMode {
+    INPUT_RECORD_MODE_OFF = 0,
+    INPUT_RECORD_MODE_RECORDING,
+    INPUT_RECORD_MODE_REPLAYING
+} inputRecordMode;
+
+typedef struct inputRecordState {
+    inputRecordMode mode;
+    u32 frame;
+
+    // Recording
+    fileHandle file;
+    f64 startTime;
+    eventHandle resizeHandle;
+    eventHandle quitHandle;
+
+    // Replay
+    inputRecordEntry* entries;
+    u64 entryCnt;
+    u64 next;
+    // Set while the replay calls into the input system itself
+    b8 feeding;
+} inputRecordState;
+
+static inputRecordState state;
+
+// Replayed window events are posted with this as the sender, so the resize
+// listener can tell them from live ones.
+static u8 replaySender;
+
+static void writeEntry(u32 frame, u8 type, u8 pressed, u16 code, i16 x, i16 y) {
+    inputRecordEntry e;
+    e.frame = frame;
+    e.timeUs = (u32)((platformGetAbsoluteTime() - state.startTime) * 1000000.0);
+    e.type = type;
+    e.pressed = pressed;
+    e.code = code;
+    e.x = x;
+    e.y = y;
+    u64 written = 0;
+    fsWriteBuffered(&state.file, sizeof(e), &e, &written);
+}
+
+// Runs ahead of everyone else on resize/quit. Records them while recording,
+// swallows live resizes while replaying.
+static b8 onWindowEvent(u16 code, void* sender, void* listenerInst, eventContext ec) {
+    if (state.mode == INPUT_RECORD_MODE_RECORDING) {
+        // Dispatched after inputRecordFrame moved on, they were posted in
+        // the frame before.
+        u32 frame = state.frame ? state.frame - 1 : 0;
+        if (code == EVENT_CODE_RESIZED) {
+            writeEntry(frame, INPUT_RECORD_RESIZE, 0, 0, (i16)ec.data.u16[0], (i16)ec.data.u16[1]);
+        } else {
+            writeEntry(frame, INPUT_RECORD_QUIT, 0, 0, 0, 0);
+        }
+        return false;
+    }
+    return state.mode == INPUT_RECORD_MODE_REPLAYING && code == EVENT_CODE_RESIZED &&
+           sender != &replaySender;
+}
+
+static void registerWindowListeners() {
+    eventRegisterHandle(EVENT_CODE_RESIZED, &state, onWindowEvent, 0x7FFF, &state.resizeHandle);
+    eventRegisterHandle(EVENT_CODE_APPLICATION_QUIT, &state, onWindowEvent, 0x7FFF, &state.quitHandle);
+}
+
+void inputRecordStop() {
+    if (state.mode == INPUT_RECORD_MODE_RECORDING) {
+        fsFlush(&state.file);
+        fsClose(&state.file);
+        FINFO("Input recording stopped after %u frames.", state.frame);
+    } else if (state.mode == INPUT_RECORD_MODE_REPLAYING && state.entries) {
+        ffree(state.entries, state.entryCnt * sizeof(inputRecordEntry), MEMORY_TAG_APPLICATION);
+        state.entries = 0;
+    }
+    if (state.mode != INPUT_RECORD_MODE_OFF) {
+        eventUnregisterHandle(state.resizeHandle);
+        eventUnregisterHandle(state.quitHandle);
+    }
+    state.mode = INPUT_RECORD_MODE_OFF;
+}
+
+b8 inputRecordStart(const char* path) {
+    inputRecordStop();
+    if (!fsOpen(path, FILE_MODE_WRITE, true, &state.file)) {
+        FERROR("Couldn't open %s to record input.", path);
+        return false;
+    }
+    inputRecordFileHeader header = {INPUT_RECORD_MAGIC, INPUT_RECORD_VERSION, 0};
+    u64 written = 0;
+    fsWrite(&state.file, sizeof(header), &header, &written);
+
+    state.frame = 0;
+    state.startTime = platformGetAbsoluteTime();
+    state.mode = INPUT_RECORD_MODE_RECORDING;
+    registerWindowListeners();
+    FINFO("Recording input to %s.", path);
+    return true;
+}
+
+b8 inputReplayStart(const char* path) {
+    inputRecordStop();
+    fileHandle file;
+    if (!fsOpen(path, FILE_MODE_READ, true, &file)) {
+        FERROR("Couldn't open input recording %s.", path);
+        return false;
+    }
+
+    inputRecordFileHeader header;
+    u64 size = 0;
+    u64 read = 0;
+    fsSize(&file, &size);
+    if (size < sizeof(header) || !fsRead(&file, sizeof(header), &header, &read) ||
+        memcmp(header.magic, INPUT_RECORD_MAGIC, 8) != 0 ||
+        header.version != INPUT_RECORD_VERSION) {
+        FERROR("%s is not an input recording.", path);
+        fsClose(&file);
+        return false;
+    }
+
+    // A recording cut short by a crash just ends at its last whole entry
+    state.entryCnt = (size - sizeof(header)) / sizeof(inputRecordEntry);
+    // An empty one has nothing to load and finishes on the first frame
+    state.entries = 0;
+    if (state.entryCnt) {
+        state.entries = fallocate(state.entryCnt * sizeof(inputRecordEntry), MEMORY_TAG_APPLICATION);
+        fsRead(&file, state.entryCnt * sizeof(inputRecordEntry), state.entries, &read);
+    }
+    fsClose(&file);
+
+    state.next = 0;
+    state.frame = 0;
+    state.mode = INPUT_RECORD_MODE_REPLAYING;
+    registerWindowListeners();
+    FINFO("Replaying %llu inputs from %s.", state.entryCnt, path);
+    return true;
+}
+
+static void feed(const inputRecordEntry* e) {
+    eventContext ec = {0};
+    // Replayed input arrives now, as far as latency goes
+    f64 now = platformGetAbsoluteTime();
+    switch (e->type) {
+        case INPUT_RECORD_KEY:
+            inputProcessKey(e->code, e->pressed, now);
+            break;
+        case INPUT_RECORD_BUTTON:
+            inputProcessButton(e->code, e->pressed, now);
+            break;
+        case INPUT_RECORD_MOUSE_MOVE:
+            inputProcessMouseMove(e->x, e->y, now);
+            break;
+        case INPUT_RECORD_MOUSE_WHEEL:
+            inputProcessMouseWheel((i8)e->code, now);
+            break;
+        case INPUT_RECORD_RESIZE:
+            ec.data.u16[0] = (u16)e->x;
+            ec.data.u16[1] = (u16)e->y;
+            eventPost(EVENT_CODE_RESIZED, &replaySender, ec);
+            break;
+        case INPUT_RECORD_QUIT:
+            ec.data.u8[0] = true;
+            eventPost(EVENT_CODE_APPLICATION_QUIT, &replaySender, ec);
+            break;
+        default:
+            break;
+    }
+}
+
+void inputRecordFrame() {
+    if (state.mode == INPUT_RECORD_MODE_RECORDING) {
+        state.frame++;
+        return;
+    }
+    if (state.mode != INPUT_RECORD_MODE_REPLAYING) {
+        return;
+    }
+
+    state.feeding = true;
+    while (state.next < state.entryCnt && state.entries[state.next].frame <= state.frame) {
+        feed(&state.entries[state.next++]);
+    }
+    state.feeding = false;
+    state.frame++;
+
+    if (state.next == state.entryCnt) {
+        FINFO("Input replay finished after %u frames.", state.frame);
+        // Recordings that end with the window being closed quit on their own
+        b8 quits = state.entryCnt && state.entries[state.entryCnt - 1].type == INPUT_RECORD_QUIT;
+        inputRecordStop();
+        if (!quits) {
+            eventContext ec = {0};
+            ec.data.u8[0] = true;
+            eventPost(EVENT_CODE_APPLICATION_QUIT, 0, ec);
+        }
+    }
+}
+
+b8 inputReplayBlocksLive() {
+    return state.mode == INPUT_RECORD_MODE_REPLAYING && !state.feeding;
+}
+
+void inputRecordKey(u16 key, b8 pressed) {
+    if (state.mode == INPUT_RECORD_MODE_RECORDING) {
+        writeEntry(state.frame, INPUT_RECORD_KEY, pressed, key, 0, 0);
+    }
+}
+
+void inputRecordButton(u16 button, b8 pressed) {
+    if (state.mode == INPUT_RECORD_MODE_RECORDING) {
+        writeEntry(state.frame, INPUT_RECORD_BUTTON, pressed, button, 0, 0);
+    }
+}
+
+void inputRecordMouseMove(i16 x, i16 y) {
+    if (state.mode == INPUT_RECORD_MODE_RECORDING) {
+        writeEntry(state.frame, INPUT_RECORD_MOUSE_MOVE, 0, 0, x, y);
+    }
+}
+
+void inputRecordMouseWheel(i8 zDelta) {
+    if (state.mode == INPUT_RECORD_MODE_RECORDING) {
+        writeEntry(state.frame, INPUT_RECORD_MOUSE_WHEEL, 0, (u8)zDelta, 0, 0);
+    }
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "defines.h"
+
+/**
+ *  Input recording and replay, for running the main loop on the exact same
+ * input every time. While recording, everything the input system is handed
+ * plus window resizes and quit requests are written to a file, tagged with
+ * the frame they arrived in. Replay feeds them back frame by frame, ignoring
+ * live input, so frame N of a replay sees what frame N of the recording saw
+ * no matter how long frames take.
+ *
+ *  File layout (native endianness):
+ *      inputRecordFileHeader
+ *      inputRecordEntry[], in the order things happened
+ */
+
+#define INPUT_RECORD_MAGIC "FSNINPT1"
+#define INPUT_RECORD_VERSION 1
+
+typedef enum inputRecordType {
+    INPUT_RECORD_KEY = 1,
+    INPUT_RECORD_BUTTON,
+    INPUT_RECORD_MOUSE_MOVE,
+    INPUT_RECORD_MOUSE_WHEEL,
+    INPUT_RECORD_RESIZE,
+    INPUT_RECORD_QUIT
+} inputRecordType;
+
+typedef struct inputRecordFileHeader {
+    char magic[8];
+    u32 version;
+    u32 reserved;
+} inputRecordFileHeader;
+
+typedef struct inputRecordEntry {
+    // Frame the input arrived in, counted from the start of the recording
+    u32 frame;
+    // Microseconds since the recording started
+    u32 timeUs;
+    u8 type;
+    // Key/button pressed
+    u8 pressed;
+    // Key, button or wheel delta (as i8)
+    u16 code;
+    // Mouse position or window width/height
+    i16 x;
+    i16 y;
+} inputRecordEntry;
+
+/**
+ * @brief Starts writing input to path. Stops any running recording or
+ * replay first. Needs the event system to be up.
+ * @returns true if successful, false if failed
+ */
+CT_API b8 inputRecordStart(const char* path);
+
+/**
+ * @brief Starts feeding the recording at path back from the next
+ * inputRecordFrame on. Live input is ignored until it is done, then an
+ * EVENT_CODE_APPLICATION_QUIT is posted.
+ * @returns true if successful, false if failed
+ */
+CT_API b8 inputReplayStart(const char* path);
+
+/**
+ * @brief Ends whichever of recording/replay is running.
+ */
+CT_API void inputRecordStop();
+
+/**
+ * @brief Call once per frame, after platformPumpMessages and before the
+ * events are dispatched. Moves the recording to the next frame, or feeds
+ * the replay's input for this frame.
+ */
+CT_API void inputRecordFrame();
+
+/**
+ * @brief True while a replay is running and live input should be dropped.
+ */
+b8 inputReplayBlocksLive();
+
+// Hooks for the input system, write the input if recording.
+void inputRecordKey(u16 key, b8 pressed);
+void inputRecordButton(u16 button, b8 pressed);
+void inputRecordMouseMove(i16 x, i16 y);
+void inputRecordMouseWheel(i8 zDelta);
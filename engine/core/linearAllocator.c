@@ -0,0 +1,43 @@
+#include "linearAllocator.h"
+
+#include "core/fmemory.h"
+#include "core/logger.h"
+
+#define LINEAR_ALLOC_ALIGNMENT 16
+
+b8 linearAllocCreate(u64 totalSize, u64* memoryRequirement, void* memory,
+                     linearAllocator* outAllocator) {
+    // Room to line the start up on the alignment
+    *memoryRequirement = totalSize + LINEAR_ALLOC_ALIGNMENT;
+    if (!memory) {
+        return true;
+    }
+
+    u64 start = ((u64)memory + LINEAR_ALLOC_ALIGNMENT - 1) & ~(u64)(LINEAR_ALLOC_ALIGNMENT - 1);
+    outAllocator->totalSize = totalSize;
+    outAllocator->allocated = 0;
+    outAllocator->memory = (void*)start;
+    return true;
+}
+
+void linearAllocDestroy(linearAllocator* allocator) {
+    allocator->totalSize = 0;
+    allocator->allocated = 0;
+    allocator->memory = 0;
+}
+
+void* linearAlloc(linearAllocator* allocator, u64 size) {
+    u64 offset = (allocator->allocated + LINEAR_ALLOC_ALIGNMENT - 1) &
+                 ~(u64)(LINEAR_ALLOC_ALIGNMENT - 1);
+    if (!size || offset + size > allocator->totalSize) {
+        FERROR("LinearAlloc can't fit %llu bytes, %llu of %llu used.", size,
+               allocator->allocated, allocator->totalSize);
+        return 0;
+    }
+    allocator->allocated = offset + size;
+    return (void*)((u64)allocator->memory + offset);
+}
+
+void linearAllocReset(linearAllocator* allocator) {
+    allocator->allocated = 0;
+}
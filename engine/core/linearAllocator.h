@@ -0,0 +1,35 @@
+#pragma once
+
+#include "defines.h"
+
+/**
+ *  Bump allocator over a fixed block. Allocations can't be freed one by one,
+ * linearAllocReset drops all of them at once. Meant for data that lives for
+ * a frame.
+ */
+
+typedef struct linearAllocator {
+    u64 totalSize;
+    u64 allocated;
+    void* memory;
+} linearAllocator;
+
+/**
+ * @brief Call with memory 0 to get the requirement, then again with a block
+ * that big.
+ */
+b8 linearAllocCreate(u64 totalSize, u64* memoryRequirement, void* memory,
+                     linearAllocator* outAllocator);
+
+void linearAllocDestroy(linearAllocator* allocator);
+
+/**
+ * @brief Allocates size bytes aligned to 16.
+ * @returns 0 if the allocator is full
+ */
+void* linearAlloc(linearAllocator* allocator, u64 size);
+
+/**
+ * @brief Frees every allocation.
+ */
+void linearAllocReset(linearAllocator* allocator);
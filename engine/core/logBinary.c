@@ -0,0 +1,395 @@
+#include "logBinary.h"
+
+#include "core/logger.h"
+#include "platform/filesystem.h"
+#include "platform/platform.h"
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+ *  Each thread gets its own buffer the first time it logs. The buffers are
+ * allocated straight from the platform (fallocate isn't thread safe) and put
+ * on a lock-free list so shutdown can write out what is left in them. They
+ * are only freed at shutdown, so a thread exiting doesn't lose its entries.
+ *  The first 8 bytes of every buffer are kept for the chunk header so a chunk
+ * goes out in a single write and can't interleave with other threads' chunks.
+ */
+
+#define LOG_BINARY_BUFFER_SIZE KIBIBYTES(64)
+#define LOG_BINARY_CHUNK_HEADER_SIZE (sizeof(u32) * 2)
+// Id given to sites whose format can't be logged binary. They log as text.
+#define LOG_BINARY_TEXT_SITE 0xFFFFFFFF
+
+typedef struct logSite {
+    const char* format;
+    const char* file;
+    u32 line;
+    u8 level;
+    u8 argCnt;
+    u8 argKinds[LOG_BINARY_MAX_ARGS];
+} logSite;
+
+typedef struct threadBuffer {
+    struct threadBuffer* next;
+    u64 len;
+    u8 data[LOG_BINARY_BUFFER_SIZE];
+} threadBuffer;
+
+typedef struct logBinaryState {
+    fileHandle file;
+    _Atomic b8 open;
+    // Last id handed out, ids start at 1
+    _Atomic u32 siteCnt;
+    threadBuffer* _Atomic buffers;
+    logSite sites[LOG_BINARY_MAX_SITES];
+} logBinaryState;
+
+// Static instead of the usual init-provided state, call sites can log before
+// the logger is up.
+static logBinaryState state;
+static FSN_THREAD_LOCAL threadBuffer* localBuffer;
+
+// Works out what printf would pull off the va_list for format. false if the
+// format uses something that can't be stored (%n, %ls, long double...).
+static b8 parseFormat(const char* format, u8* outKinds, u8* outCnt) {
+    u8 cnt = 0;
+    for (const char* p = format; *p; p++) {
+        if (*p != '%') {
+            continue;
+        }
+        p++;
+        if (*p == '%') {
+            continue;
+        }
+
+        // Flags, width and precision. '*' takes an int off the list.
+        while (*p && strchr("-+ #0", *p)) {
+            p++;
+        }
+        for (b8 precision = false;; precision = true) {
+            if (*p == '*') {
+                if (cnt == LOG_BINARY_MAX_ARGS) {
+                    return false;
+                }
+                outKinds[cnt++] = LOG_BINARY_ARG_INT;
+                p++;
+            } else {
+                while (*p >= '0' && *p <= '9') {
+                    p++;
+                }
+            }
+            if (precision || *p != '.') {
+                break;
+            }
+            p++;
+        }
+
+        logBinaryArg intKind = LOG_BINARY_ARG_INT;
+        b8 longDouble = false;
+        b8 wide = false;
+        switch (*p) {
+        case 'h':
+            p += p[1] == 'h' ? 2 : 1;
+            break;
+        case 'l':
+            if (p[1] == 'l') {
+                intKind = LOG_BINARY_ARG_LONG_LONG;
+                p += 2;
+            } else {
+                intKind = LOG_BINARY_ARG_LONG;
+                wide = true;
+                p++;
+            }
+            break;
+        case 'z':
+            intKind = LOG_BINARY_ARG_SIZE;
+            p++;
+            break;
+        case 'j':
+            intKind = LOG_BINARY_ARG_INTMAX;
+            p++;
+            break;
+        case 't':
+            intKind = LOG_BINARY_ARG_PTRDIFF;
+            p++;
+            break;
+        case 'L':
+            longDouble = true;
+            p++;
+            break;
+        }
+
+        if (cnt == LOG_BINARY_MAX_ARGS) {
+            return false;
+        }
+        switch (*p) {
+        case 'd':
+        case 'i':
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+            outKinds[cnt++] = intKind;
+            break;
+        case 'c':
+            // wint_t is promoted to int/unsigned as well
+            outKinds[cnt++] = LOG_BINARY_ARG_INT;
+            break;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            if (longDouble) {
+                return false;
+            }
+            outKinds[cnt++] = LOG_BINARY_ARG_DOUBLE;
+            break;
+        case 's':
+            if (wide) {
+                return false;
+            }
+            outKinds[cnt++] = LOG_BINARY_ARG_STR;
+            break;
+        case 'p':
+            outKinds[cnt++] = LOG_BINARY_ARG_PTR;
+            break;
+        default:
+            // %n, wide chars or a broken format
+            return false;
+        }
+    }
+    *outCnt = cnt;
+    return true;
+}
+
+static void flushBuffer(threadBuffer* b) {
+    if (b->len <= LOG_BINARY_CHUNK_HEADER_SIZE) {
+        return;
+    }
+    if (atomic_load_explicit(&state.open, memory_order_acquire)) {
+        u32 header[2] = {LOG_BINARY_CHUNK_MAGIC,
+                         (u32)(b->len - LOG_BINARY_CHUNK_HEADER_SIZE)};
+        memcpy(b->data, header, sizeof(header));
+        u64 written = 0;
+        fsWriteBuffered(&state.file, b->len, b->data, &written);
+    }
+    // Without a file yet there is nowhere to put it. The site records get
+    // written again by logBinaryInit, only the messages are lost.
+    b->len = LOG_BINARY_CHUNK_HEADER_SIZE;
+}
+
+static threadBuffer* acquireBuffer() {
+    if (localBuffer) {
+        return localBuffer;
+    }
+    threadBuffer* b = platformAllocate(sizeof(threadBuffer), false);
+    b->len = LOG_BINARY_CHUNK_HEADER_SIZE;
+    b->next = atomic_load_explicit(&state.buffers, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(&state.buffers, &b->next, b,
+                                                  memory_order_release,
+                                                  memory_order_relaxed)) {
+    }
+    localBuffer = b;
+    return b;
+}
+
+// Makes sure size bytes fit, flushing the buffer if they don't
+FSN_INLINE u8* reserve(threadBuffer* b, u64 size) {
+    if (b->len + size > LOG_BINARY_BUFFER_SIZE) {
+        flushBuffer(b);
+    }
+    return b->data + b->len;
+}
+
+static void writeSiteRecord(threadBuffer* b, u32 id) {
+    logSite* site = &state.sites[id];
+    u16 fmtLen = (u16)strlen(site->format);
+    u16 fileLen = (u16)strlen(site->file);
+    u64 size = 1 + 4 + 1 + 4 + 1 + site->argCnt + 2 + fmtLen + 2 + fileLen;
+    if (size > LOG_BINARY_BUFFER_SIZE - LOG_BINARY_CHUNK_HEADER_SIZE) {
+        return;
+    }
+
+    u8* p = reserve(b, size);
+    *p++ = LOG_BINARY_RECORD_SITE;
+    memcpy(p, &id, 4);
+    p += 4;
+    *p++ = site->level;
+    memcpy(p, &site->line, 4);
+    p += 4;
+    *p++ = site->argCnt;
+    memcpy(p, site->argKinds, site->argCnt);
+    p += site->argCnt;
+    memcpy(p, &fmtLen, 2);
+    p += 2;
+    memcpy(p, site->format, fmtLen);
+    p += fmtLen;
+    memcpy(p, &fileLen, 2);
+    p += 2;
+    memcpy(p, site->file, fileLen);
+    p += fileLen;
+    b->len = p - b->data;
+}
+
+static u32 registerSite(threadBuffer* b, u8 level, const char* file, u32 line,
+                        const char* format) {
+    u8 kinds[LOG_BINARY_MAX_ARGS];
+    u8 argCnt = 0;
+    if (!parseFormat(format, kinds, &argCnt)) {
+        return LOG_BINARY_TEXT_SITE;
+    }
+    u32 id = atomic_fetch_add_explicit(&state.siteCnt, 1,
+                                       memory_order_relaxed) + 1;
+    if (id >= LOG_BINARY_MAX_SITES) {
+        return LOG_BINARY_TEXT_SITE;
+    }
+
+    logSite* site = &state.sites[id];
+    site->file = file;
+    site->line = line;
+    site->level = level;
+    site->argCnt = argCnt;
+    memcpy(site->argKinds, kinds, argCnt);
+    atomic_thread_fence(memory_order_release);
+    site->format = format;
+
+    writeSiteRecord(b, id);
+    return id;
+}
+
+b8 logBinaryInit(const char* path) {
+    if (!fsOpen(path, FILE_MODE_WRITE, true, &state.file)) {
+        FERROR("Couldn't open %s for the binary log.", path);
+        return false;
+    }
+    logBinaryFileHeader header = {LOG_BINARY_MAGIC, LOG_BINARY_VERSION, 0};
+    u64 written = 0;
+    fsWrite(&state.file, sizeof(header), &header, &written);
+    atomic_store_explicit(&state.open, true, memory_order_release);
+
+    // Describe every site that logged before the file existed, their first
+    // records might have been dropped.
+    threadBuffer* b = acquireBuffer();
+    u32 cnt = atomic_load_explicit(&state.siteCnt, memory_order_acquire);
+    for (u32 id = 1; id <= cnt && id < LOG_BINARY_MAX_SITES; id++) {
+        if (state.sites[id].format) {
+            writeSiteRecord(b, id);
+        }
+    }
+    flushBuffer(b);
+    return true;
+}
+
+void logBinaryShutdown() {
+    if (!atomic_load_explicit(&state.open, memory_order_acquire)) {
+        return;
+    }
+    threadBuffer* b = atomic_exchange_explicit(&state.buffers, 0,
+                                               memory_order_acq_rel);
+    while (b) {
+        threadBuffer* next = b->next;
+        flushBuffer(b);
+        platformFree(b, false);
+        b = next;
+    }
+    localBuffer = 0;
+
+    atomic_store_explicit(&state.open, false, memory_order_release);
+    fsClose(&state.file);
+}
+
+void logBinaryFlushThread() {
+    if (localBuffer) {
+        flushBuffer(localBuffer);
+        if (atomic_load_explicit(&state.open, memory_order_acquire)) {
+            fsFlush(&state.file);
+        }
+    }
+}
+
+void logBinaryWrite(_Atomic u32* siteId, u8 level, const char* file, u32 line,
+                    const char* format, ...) {
+    threadBuffer* b = acquireBuffer();
+    u32 id = atomic_load_explicit(siteId, memory_order_acquire);
+    if (!id) {
+        id = registerSite(b, level, file, line, format);
+        atomic_store_explicit(siteId, id, memory_order_release);
+    }
+
+    va_list args;
+    va_start(args, format);
+    // A site passing a non-literal format (FDEBUG(someString)) can't reuse
+    // the format it registered with.
+    if (id == LOG_BINARY_TEXT_SITE || state.sites[id].format != format) {
+        logOutputV(level, format, args);
+        va_end(args);
+        return;
+    }
+
+    const logSite* site = &state.sites[id];
+    // Worst case size so the record never has to be split
+    u8* p = reserve(b, 1 + 4 + 8 + site->argCnt * (2 + LOG_BINARY_MAX_STR_LEN));
+    *p++ = LOG_BINARY_RECORD_MESSAGE;
+    memcpy(p, &id, 4);
+    p += 4;
+    f64 now = platformGetAbsoluteTime();
+    memcpy(p, &now, 8);
+    p += 8;
+
+    for (u8 i = 0; i < site->argCnt; i++) {
+        u64 value = 0;
+        switch (site->argKinds[i]) {
+        case LOG_BINARY_ARG_INT:
+            value = (u64)(i64)va_arg(args, int);
+            break;
+        case LOG_BINARY_ARG_LONG:
+            value = (u64)(i64)va_arg(args, long);
+            break;
+        case LOG_BINARY_ARG_LONG_LONG:
+            value = (u64)va_arg(args, long long);
+            break;
+        case LOG_BINARY_ARG_SIZE:
+            value = (u64)va_arg(args, size_t);
+            break;
+        case LOG_BINARY_ARG_INTMAX:
+            value = (u64)va_arg(args, intmax_t);
+            break;
+        case LOG_BINARY_ARG_PTRDIFF:
+            value = (u64)va_arg(args, ptrdiff_t);
+            break;
+        case LOG_BINARY_ARG_DOUBLE: {
+            f64 d = va_arg(args, double);
+            memcpy(&value, &d, 8);
+            break;
+        }
+        case LOG_BINARY_ARG_PTR:
+            value = (u64)(uintptr_t)va_arg(args, void*);
+            break;
+        case LOG_BINARY_ARG_STR: {
+            const char* s = va_arg(args, const char*);
+            if (!s) {
+                s = "(null)";
+            }
+            u16 len = 0;
+            while (len < LOG_BINARY_MAX_STR_LEN && s[len]) {
+                len++;
+            }
+            memcpy(p, &len, 2);
+            memcpy(p + 2, s, len);
+            p += 2 + len;
+            continue;
+        }
+        }
+        memcpy(p, &value, 8);
+        p += 8;
+    }
+    va_end(args);
+    b->len = p - b->data;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "defines.h"
+
+#include <stdatomic.h>
+
+/**
+ *  Binary log mode. Instead of formatting, a call site registers its format
+ * string once and from then on only writes its id, a timestamp and the raw
+ * argument bytes into a buffer owned by the calling thread. Full buffers are
+ * written to the binary log file as one chunk. tools/logDecoder turns the file
+ * back into text.
+ *
+ *  File layout (native endianness):
+ *      logBinaryFileHeader
+ *      chunks: u32 LOG_BINARY_CHUNK_MAGIC, u32 size, `size` bytes of records
+ *  Records:
+ *      SITE:    u8 type, u32 id, u8 level, u32 line, u8 argCnt,
+ *               u8 argKinds[argCnt], u16 fmtLen, fmt, u16 fileLen, file
+ *      MESSAGE: u8 type, u32 id, f64 time, then per argument:
+ *               integers/doubles/pointers as 8 bytes, strings as u16 len + chars
+ *  A site is always described before its first message in the same thread's
+ * chunks, but chunks from different threads can land in any order, so readers
+ * should collect every SITE record before decoding messages.
+ */
+
+#define LOG_BINARY_MAGIC "FSNBLOG1"
+#define LOG_BINARY_VERSION 1
+#define LOG_BINARY_CHUNK_MAGIC 0x4B4E4843 // "CHNK"
+
+// Max amount of distinct call sites
+#define LOG_BINARY_MAX_SITES 4096
+// Max amount of arguments per call site
+#define LOG_BINARY_MAX_ARGS 16
+// %s arguments are cut to this many chars
+#define LOG_BINARY_MAX_STR_LEN 256
+
+typedef enum logBinaryRecord {
+    LOG_BINARY_RECORD_SITE = 1,
+    LOG_BINARY_RECORD_MESSAGE = 2
+} logBinaryRecord;
+
+// How an argument was read off the va_list. Integers are always stored as 8
+// bytes, the kind tells the decoder which type to hand back to printf.
+typedef enum logBinaryArg {
+    LOG_BINARY_ARG_INT = 0,
+    LOG_BINARY_ARG_LONG,
+    LOG_BINARY_ARG_LONG_LONG,
+    LOG_BINARY_ARG_SIZE,
+    LOG_BINARY_ARG_INTMAX,
+    LOG_BINARY_ARG_PTRDIFF,
+    LOG_BINARY_ARG_DOUBLE,
+    LOG_BINARY_ARG_PTR,
+    LOG_BINARY_ARG_STR
+} logBinaryArg;
+
+typedef struct logBinaryFileHeader {
+    char magic[8];
+    u32 version;
+    u32 reserved;
+} logBinaryFileHeader;
+
+/**
+ * @brief Opens the binary log file. Sites registered before this are written
+ * out straight away.
+ */
+b8 logBinaryInit(const char* path);
+
+/**
+ * @brief Writes out every thread's buffer and closes the file. Other threads
+ * must have stopped logging by now.
+ */
+void logBinaryShutdown();
+
+/**
+ * @brief Writes out the calling thread's buffer.
+ */
+CT_API void logBinaryFlushThread();
+
+/**
+ * @brief Hot path of FSN_LOG_BINARY. siteId is the call site's static id
+ * slot, it gets filled in the first time the site logs.
+ */
+CT_API void logBinaryWrite(_Atomic u32* siteId, u8 level, const char* file,
+                           u32 line, const char* format, ...);
+
+// Logs through the binary log. Use like logOutput.
+#define FSN_LOG_BINARY(level, message, ...)                                    \
+    do {                                                                       \
+        static _Atomic u32 logSiteId;                                          \
+        logBinaryWrite(&logSiteId, level, __FILE__, __LINE__, message,         \
+                       ##__VA_ARGS__);                                         \
+    } while (0)
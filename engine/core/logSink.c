@@ -0,0 +1,126 @@
+#include "logSink.h"
+
+#include "core/fstring.h"
+#include "core/strBuilder.h"
+#include "platform/filesystem.h"
+
+// Nothing in here may log, the logger's writer holds the lock while calling
+// in and would end up waiting on itself.
+
+FSN_INLINE void sinkLock(logSink* sink) {
+    while (atomic_flag_test_and_set_explicit(&sink->lock,
+                                             memory_order_acquire)) {
+    }
+}
+
+FSN_INLINE void sinkUnlock(logSink* sink) {
+    atomic_flag_clear_explicit(&sink->lock, memory_order_release);
+}
+
+// path with ".idx" added. idx 0 is the path itself.
+static void rotatedName(const char* path, u32 idx, char* out, u64 outSize) {
+    strBuilder sb;
+    strBuilderInit(&sb, out, outSize);
+    strBuilderAppend(&sb, path);
+    if (idx) {
+        strBuilderAppendFmt(&sb, ".%u", idx);
+    }
+    // Paths are capped to LOG_SINK_MAX_PATH so this never leaves out.
+    strBuilderDestroy(&sb);
+}
+
+// Cuts off the zero filled tail and any half written entry a crash left in
+// the file at path.
+static void trimCrashedFile(const char* path) {
+    platformMappedFile file;
+    if (!platformFileMap(path, 0, &file)) {
+        return;
+    }
+    const char* data = file.data;
+    u64 end = file.size;
+    while (end && data[end - 1] == 0) {
+        end--;
+    }
+    while (end && data[end - 1] != '\n') {
+        end--;
+    }
+    platformFileUnmap(&file, end);
+}
+
+// path.(keep-1) -> path.keep ... path -> path.1
+static void shiftFiles(logSink* sink) {
+    char from[LOG_SINK_MAX_PATH + 16];
+    char to[LOG_SINK_MAX_PATH + 16];
+    if (!sink->keepFiles) {
+        fsRemove(sink->path);
+        return;
+    }
+    for (u32 i = sink->keepFiles; i > 0; i--) {
+        rotatedName(sink->path, i - 1, from, sizeof(from));
+        rotatedName(sink->path, i, to, sizeof(to));
+        if (fsExists(from)) {
+            fsRename(from, to);
+        }
+    }
+}
+
+static b8 rotate(logSink* sink) {
+    if (sink->file.handle || sink->file.data) {
+        platformFileUnmap(&sink->file, sink->used);
+    }
+    shiftFiles(sink);
+    sink->used = 0;
+    return platformFileMap(sink->path, sink->capacity, &sink->file);
+}
+
+b8 logSinkOpen(logSink* sink, const char* path, u64 capacity, u32 keepFiles) {
+    if (!capacity || strLen(path) >= LOG_SINK_MAX_PATH) {
+        return false;
+    }
+    strCpy(sink->path, path);
+    sink->capacity = capacity;
+    sink->keepFiles = keepFiles;
+    sink->used = 0;
+    platformZeroMemory(&sink->file, sizeof(platformMappedFile));
+    atomic_flag_clear(&sink->lock);
+
+    if (fsExists(path)) {
+        trimCrashedFile(path);
+    }
+    return rotate(sink);
+}
+
+void logSinkClose(logSink* sink) {
+    sinkLock(sink);
+    if (sink->file.data) {
+        platformFileUnmap(&sink->file, sink->used);
+    }
+    sinkUnlock(sink);
+}
+
+void logSinkWrite(logSink* sink, const char* data, u64 len) {
+    sinkLock(sink);
+    if (sink->used + len > sink->capacity && sink->used) {
+        if (!rotate(sink)) {
+            // Out of disk or similar. Drop it rather than block the logger.
+            sinkUnlock(sink);
+            return;
+        }
+    }
+    if (!sink->file.data) {
+        sinkUnlock(sink);
+        return;
+    }
+    if (len > sink->capacity) {
+        len = sink->capacity;
+    }
+    platformCopyMemory((u8*)sink->file.data + sink->used, data, len);
+    sink->used += len;
+    sinkUnlock(sink);
+}
+
+void logSinkFlush(logSink* sink) {
+    sinkLock(sink);
+    platformFileMapFlush(&sink->file);
+    sinkUnlock(sink);
+}
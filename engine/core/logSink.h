@@ -0,0 +1,57 @@
+#pragma once
+
+#include "defines.h"
+#include "platform/platform.h"
+
+#include <stdatomic.h>
+
+/**
+ *  Size capped log file backed by a memory mapping. The file is sized to
+ * `capacity` up front so writing an entry is just a memcpy, and whatever was
+ * copied survives the process crashing.
+ *  Once an entry doesn't fit anymore the file is cut to what was written and
+ * rotated: path -> path.1 -> path.2 ... up to keepFiles old files, and a
+ * fresh one is mapped. The disk footprint stays around
+ * capacity * (keepFiles + 1).
+ *  A file left behind by a crash still has its zero filled tail and maybe a
+ * half written entry. Opening the sink trims those off before rotating it.
+ *  Writes are serialized with a spinlock, any thread can write.
+ */
+
+#define LOG_SINK_MAX_PATH 256
+
+typedef struct logSink {
+    platformMappedFile file;
+    char path[LOG_SINK_MAX_PATH];
+    u64 capacity;
+    u64 used;
+    u32 keepFiles;
+    atomic_flag lock;
+} logSink;
+
+/**
+ * @brief Rotates any existing log at path and maps a fresh one.
+ * @param sink The sink
+ * @param path Path of the current log file
+ * @param capacity Max size of a single log file in bytes
+ * @param keepFiles Amount of rotated files to keep
+ * @returns true if successful, false if failed
+ */
+b8 logSinkOpen(logSink* sink, const char* path, u64 capacity, u32 keepFiles);
+
+/**
+ * @brief Cuts the file down to what was written and unmaps it.
+ */
+void logSinkClose(logSink* sink);
+
+/**
+ * @brief Copies len bytes into the file, rotating first if they don't fit.
+ * Entries are never split across files, ones bigger than capacity are cut.
+ */
+void logSinkWrite(logSink* sink, const char* data, u64 len);
+
+/**
+ * @brief Asks the OS to start writing the file out. Only matters for the OS
+ * going down, the process dying doesn't lose anything.
+ */
+void logSinkFlush(logSink* sink);
@@ -1,26 +1,174 @@
 #include "logger.h"
 #include "platform/platform.h"
-#include "platform/filesystem.h"
 #include "helpers/dinoarray.h"
+#include "helpers/ringbuffer.h"
+#include "core/logSink.h"
+#include "core/strBuilder.h"
 
-// TODO: temporary
-#include <stdio.h>
-#include <string.h>
 #include <stdarg.h>
+#include <stdatomic.h>
+
+/*
+ *  Log calls format their entry into a fixed size slot and push it onto a MPMC
+ * ring, so the calling thread never touches the console, the file or the
+ * allocator. Entries too long for a slot are cut off and end in "...". A
+ * background writer pops the entries, prints them and copies the file output
+ * into the memory mapped log (see logSink.h), asking the OS to write it out
+ * every LOG_FLUSH_INTERVAL seconds.
+ *  Entries are written straight through on the calling thread (after letting
+ * the writer catch up so the order is kept) when the logger isn't running yet,
+ * the ring is full, or it's FATAL. Once a FATAL
+ * entry returns it is in the mapped file, so it survives the app dying.
+ */
+
+// Room for the level prefix, message and newline of a single queued entry
+#define LOG_ENTRY_TEXT_SIZE 1020
+#define LOG_RING_CAPACITY 1024
+// Size cap of a single log file and how many rotated ones are kept
+#define LOG_FILE_MAX_SIZE MEBIBYTES(8)
+#define LOG_FILE_KEEP 3
+// Seconds between file flushes while entries keep coming in
+#define LOG_FLUSH_INTERVAL 0.25
+// How long a flush waits for the writer before giving up (seconds)
+#define LOG_FLUSH_TIMEOUT 1.0
+
+typedef enum logTarget {
+    LOG_TARGET_CONSOLE = 0x1,
+    LOG_TARGET_FILE = 0x2
+} logTarget;
+
+typedef struct logEntry {
+    u16 len;
+    u8 level;
+    u8 targets;
+    char text[LOG_ENTRY_TEXT_SIZE];
+} logEntry;
 
 typedef struct loggerState{
-    char* logQueue;
-    u64 fileLogQueueCnt;
-    fileHandle fileHandle;
+    logSink file;
+    mpmcRing queue;
+    platformThread writer;
+    _Atomic b8 running;
+    // Entries pushed onto the queue / entries the writer has fully written out.
+    // Flushing waits for completed to catch up with submitted.
+    _Atomic u64 submitted;
+    _Atomic u64 completed;
+    // The writer sleeps on wake while there's nothing queued, writerAsleep
+    // is set while it does
+    platformSemaphore wake;
+    _Atomic b8 writerAsleep;
+    // Threads in waitForWriter, woken through flushed as entries complete
+    platformSemaphore flushed;
+    _Atomic i32 flushWaiters;
 } loggerState;
 
 static loggerState* systemPtr;
 
-void sendTextToFile(const char* m){
-    u64 l = strlen(m);
-    u64 written = 0;
-    if (!fsWrite(&systemPtr->fileHandle, l, m, &written)){
-        FERROR("Failed to write to log file");
+static void consoleWrite(logLevel level, const char* text){
+    if(level < LOG_LEVEL_WARN){
+        platformConsoleWriteError(text,level);
+    }else{
+        platformConsoleWrite(text,level);
+    }
+}
+
+// Builds "[LEVEL]: message\n" in one pass.
+static void logFormat(strBuilder* sb, logLevel level, const char* message, va_list args){
+    static const strView levelStr[6] = {{"[FATAL]: ", 9}, {"[ERROR]: ", 9}, {"[WARN]:  ", 9},
+                                        {"[INFO]:  ", 9}, {"[DEBUG]: ", 9}, {"[TRACE]: ", 9}};
+    strBuilderAppendView(sb, levelStr[level]);
+    strBuilderAppendFmtV(sb, message, args);
+    strBuilderAppendChar(sb, '\n');
+}
+
+// Pops everything that is queued right now. Returns the amount of entries.
+static u32 drainQueue(){
+    logEntry entry;
+    u32 cnt = 0;
+    while (mpmcRingPop(&systemPtr->queue, &entry)){
+        if (entry.targets & LOG_TARGET_CONSOLE){
+            consoleWrite(entry.level, entry.text);
+        }
+        if (entry.targets & LOG_TARGET_FILE){
+            logSinkWrite(&systemPtr->file, entry.text, entry.len);
+        }
+        // seq_cst pairs with waitForWriter, see notifyFlushWaiters
+        atomic_fetch_add_explicit(&systemPtr->completed, 1, memory_order_seq_cst);
+        cnt++;
+    }
+    return cnt;
+}
+
+static void wakeWriter(){
+    // Pairs with the seq_cst store of writerAsleep in loggerWriterThread,
+    // after a seq_cst change to submitted. Either the writer sees the entry
+    // before it sleeps or this sees it asleep.
+    if (atomic_load_explicit(&systemPtr->writerAsleep, memory_order_seq_cst) &&
+        atomic_exchange_explicit(&systemPtr->writerAsleep, false, memory_order_seq_cst)){
+        platformSemaphoreSignal(&systemPtr->wake, 1);
+    }
+}
+
+static void notifyFlushWaiters(){
+    i32 waiters = atomic_load_explicit(&systemPtr->flushWaiters, memory_order_seq_cst);
+    if (waiters > 0){
+        platformSemaphoreSignal(&systemPtr->flushed, (u32)waiters);
+    }
+}
+
+static u32 loggerWriterThread(void* params){
+    const u64 flushIntervalNs = (u64)(LOG_FLUSH_INTERVAL * 1000000000.0);
+    u64 lastFlush = platformGetAbsoluteTimeNs();
+    b8 dirty = false;
+    while (atomic_load_explicit(&systemPtr->running, memory_order_acquire)){
+        u32 cnt = drainQueue();
+        if (cnt){
+            dirty = true;
+            notifyFlushWaiters();
+        }
+
+        u64 now = platformGetAbsoluteTimeNs();
+        if (dirty && now - lastFlush >= flushIntervalNs){
+            logSinkFlush(&systemPtr->file);
+            lastFlush = now;
+            dirty = false;
+        }
+        if (cnt){
+            continue;
+        }
+
+        // Nothing queued. Sleep until something is, or until the pending
+        // flush is due. With nothing to flush the writer doesn't wake at all.
+        u64 timeout = dirty ? lastFlush + flushIntervalNs - now : PLATFORM_WAIT_INFINITE;
+        atomic_store_explicit(&systemPtr->writerAsleep, true, memory_order_seq_cst);
+        if (atomic_load_explicit(&systemPtr->completed, memory_order_seq_cst) <
+                atomic_load_explicit(&systemPtr->submitted, memory_order_seq_cst) ||
+            !atomic_load_explicit(&systemPtr->running, memory_order_seq_cst)){
+            timeout = 0;
+        }
+        platformSemaphoreWait(&systemPtr->wake, timeout);
+        atomic_store_explicit(&systemPtr->writerAsleep, false, memory_order_relaxed);
+    }
+    return 0;
+}
+
+// Waits until the writer has written everything queued before this call.
+static void waitForWriter(){
+    const u64 timeoutNs = (u64)(LOG_FLUSH_TIMEOUT * 1000000000.0);
+    u64 target = atomic_load_explicit(&systemPtr->submitted, memory_order_acquire);
+    u64 start = platformGetAbsoluteTimeNs();
+    while (atomic_load_explicit(&systemPtr->completed, memory_order_acquire) < target){
+        u64 elapsed = platformGetAbsoluteTimeNs() - start;
+        if (elapsed > timeoutNs){
+            platformConsoleWriteError("[ERROR]: Timed out waiting for the log writer\n", LOG_LEVEL_ERROR);
+            return;
+        }
+        // Same handshake as wakeWriter, on completed and flushWaiters
+        atomic_fetch_add_explicit(&systemPtr->flushWaiters, 1, memory_order_seq_cst);
+        if (atomic_load_explicit(&systemPtr->completed, memory_order_seq_cst) < target){
+            platformSemaphoreWait(&systemPtr->flushed, timeoutNs - elapsed);
+        }
+        atomic_fetch_sub_explicit(&systemPtr->flushWaiters, 1, memory_order_relaxed);
     }
 }
 
@@ -29,73 +177,156 @@ b8 loggerInit(u64* memoryRequirement, void* state) {
     if (state == 0){
         return true;
     }
-    systemPtr = state;
+    loggerState* s = state;
+    atomic_init(&s->running, false);
+    atomic_init(&s->submitted, 0);
+    atomic_init(&s->completed, 0);
+    atomic_init(&s->writerAsleep, false);
+    atomic_init(&s->flushWaiters, 0);
 
-    if (!fsOpen("appLogger.log", FILE_MODE_WRITE, false, &systemPtr->fileHandle)){
+    if (!logSinkOpen(&s->file, "appLogger.log", LOG_FILE_MAX_SIZE, LOG_FILE_KEEP)){
         FERROR("Couldn't open appLogger.log to write logs.");
         return false;
     }
+    if (!mpmcRingCreate(sizeof(logEntry), LOG_RING_CAPACITY, &s->queue)){
+        FERROR("Couldn't create the log queue.");
+        logSinkClose(&s->file);
+        return false;
+    }
+    if (!platformSemaphoreCreate(0, &s->wake) || !platformSemaphoreCreate(0, &s->flushed)){
+        FERROR("Couldn't create the log writer's semaphores.");
+        mpmcRingDestroy(&s->queue);
+        logSinkClose(&s->file);
+        return false;
+    }
+
+    systemPtr = s;
+#if LOG_BINARY_ENABLED == 1
+    logBinaryInit("appLogger.blog");
+#endif
+    atomic_store_explicit(&systemPtr->running, true, memory_order_release);
+    if (!platformThreadCreate(loggerWriterThread, 0, &systemPtr->writer)){
+        // Still usable, everything just gets written on the calling thread
+        atomic_store_explicit(&systemPtr->running, false, memory_order_release);
+        FWARN("Couldn't start the log writer thread. Logging synchronously.");
+    }
     return true;
 }
 
 void loggerShutdown() {
+    if (!systemPtr){
+        return;
+    }
+    if (atomic_exchange_explicit(&systemPtr->running, false, memory_order_seq_cst)){
+        platformSemaphoreSignal(&systemPtr->wake, 1);
+        platformThreadJoin(&systemPtr->writer);
+    }
+    // Anything pushed while the writer was stopping
+    drainQueue();
+#if LOG_BINARY_ENABLED == 1
+    logBinaryShutdown();
+#endif
+
+    loggerState* s = systemPtr;
     systemPtr = 0;
-    // TODO: cleanup logging/write queued entries.
+    mpmcRingDestroy(&s->queue);
+    platformSemaphoreDestroy(&s->wake);
+    platformSemaphoreDestroy(&s->flushed);
+    logSinkClose(&s->file);
 }
 
-void logToFile(logLevel level, b8 logToConsole, const char* message, ...){
-    const char* levelStr[6] = {"[FATAL]: ", "[ERROR]: ", "[WARN]:  ", "[INFO]:  ", "[DEBUG]: ", "[TRACE]: "};
-    b8 isError = level < 2;
-
-    // Technically imposes a 32k character limit on a single log entry, but...
-    // DON'T DO THAT!
-    char outMessage[32000];
-    memset(outMessage, 0, sizeof(outMessage));
-
-    // Format original message.
-    __builtin_va_list arg_ptr;
-    va_start(arg_ptr, message);
-    vsnprintf(outMessage, 32000, message, arg_ptr);
-    va_end(arg_ptr);
-
-    char finalMessage[32000];
-    sprintf(finalMessage, "%s%s\n", levelStr[level], outMessage);
-
-    if (logToConsole){
-        if(isError){
-            platformConsoleWriteError(finalMessage,level);
-        }else{
-            platformConsoleWrite(finalMessage,level);
+void loggerFlush(){
+    if (!systemPtr){
+        return;
+    }
+    if (atomic_load_explicit(&systemPtr->running, memory_order_acquire)){
+        waitForWriter();
+    }
+    logSinkFlush(&systemPtr->file);
+}
+
+// Marks the end of entries that didn't fit their slot
+static const char truncatedMark[] = "...\n";
+
+static void logSubmit(logLevel level, u8 targets, const char* message, va_list args){
+    logEntry entry;
+    strBuilder sb;
+    // Never grows: fmemory isn't thread safe and this runs on any thread.
+    // Longer entries are cut off at the slot.
+    strBuilderInitFixed(&sb, entry.text, sizeof(entry.text));
+    logFormat(&sb, level, message, args);
+    if (sb.truncated){
+        sb.len -= sizeof(truncatedMark) - 1;
+        strBuilderAppendN(&sb, truncatedMark, sizeof(truncatedMark) - 1);
+    }
+
+    b8 running = systemPtr && atomic_load_explicit(&systemPtr->running, memory_order_acquire);
+    if (!systemPtr){
+        targets &= ~LOG_TARGET_FILE;
+    }
+
+    if (running && level != LOG_LEVEL_FATAL){
+        entry.len = sb.len;
+        entry.level = level;
+        entry.targets = targets;
+        if (mpmcRingPush(&systemPtr->queue, &entry)){
+            atomic_fetch_add_explicit(&systemPtr->submitted, 1, memory_order_seq_cst);
+            wakeWriter();
+            return;
         }
     }
 
-    sendTextToFile(finalMessage);
+    // Write it here. Let the writer get everything before it out first so
+    // the order is kept.
+    if (running){
+        waitForWriter();
+    }
+    if (targets & LOG_TARGET_CONSOLE){
+        consoleWrite(level, strBuilderCStr(&sb));
+    }
+    if (targets & LOG_TARGET_FILE){
+        logSinkWrite(&systemPtr->file, strBuilderCStr(&sb), sb.len);
+    }
+}
+
+void logToFile(logLevel level, b8 logToConsole, const char* message, ...){
+    va_list args;
+    va_start(args, message);
+    logSubmit(level, LOG_TARGET_FILE | (logToConsole ? LOG_TARGET_CONSOLE : 0), message, args);
+    va_end(args);
 }
 
 void logOutput(logLevel level, const char* message, ...) {
-    const char* levelStr[6] = {"[FATAL]: ", "[ERROR]: ", "[WARN]:  ", "[INFO]:  ", "[DEBUG]: ", "[TRACE]: "};
-    b8 isError = level < 2;
-
-    // Technically imposes a 32k character limit on a single log entry, but...
-    // DON'T DO THAT!
-    char outMessage[32000];
-    memset(outMessage, 0, sizeof(outMessage));
-
-    // Format original message.
-    __builtin_va_list arg_ptr;
-    va_start(arg_ptr, message);
-    vsnprintf(outMessage, 32000, message, arg_ptr);
-    va_end(arg_ptr);
-
-    char finalMessage[32000];
-    sprintf(finalMessage, "%s%s\n", levelStr[level], outMessage);
-
-    // TODO: platform-specific output.
-    if(isError){
-        platformConsoleWriteError(finalMessage,level);
-    }else{
-        platformConsoleWrite(finalMessage,level);
+    va_list args;
+    va_start(args, message);
+    logSubmit(level, LOG_TARGET_CONSOLE, message, args);
+    va_end(args);
+}
+
+void logOutputV(logLevel level, const char* message, va_list args) {
+    logSubmit(level, LOG_TARGET_CONSOLE, message, args);
+}
+
+b8 logRateLimitAllow(logRateLimit* limit, u32 perSecond, logLevel level,
+                     const char* file, i32 line) {
+    u32 window = (u32)platformGetAbsoluteTime();
+    u32 current = atomic_load_explicit(&limit->window, memory_order_relaxed);
+    if (window != current &&
+        atomic_compare_exchange_strong_explicit(&limit->window, &current, window,
+                                                memory_order_relaxed, memory_order_relaxed)) {
+        // Whoever moves the window on reports the last one
+        atomic_store_explicit(&limit->count, 0, memory_order_relaxed);
+        u32 suppressed = atomic_exchange_explicit(&limit->suppressed, 0, memory_order_relaxed);
+        if (suppressed){
+            logOutput(level, "%s:%d: suppressed %u messages in the last second", file, line, suppressed);
+        }
+    }
+
+    if (atomic_fetch_add_explicit(&limit->count, 1, memory_order_relaxed) < perSecond){
+        return true;
     }
+    atomic_fetch_add_explicit(&limit->suppressed, 1, memory_order_relaxed);
+    return false;
 }
 
 void reportAssertFailure(const char* expression, const char* message, const char* file, i32 line) {
@@ -2,15 +2,39 @@
 
 #include "defines.h"
 
-#define LOG_WARN_ENABLED 1
-#define LOG_INFO_ENABLED 1
-#define LOG_DEBUG_ENABLED 1
-#define LOG_TRACE_ENABLED 1
+#include <stdarg.h>
+#include <stdatomic.h>
 
-// Disable debug and trace logging for release builds.
+// Least severe level that gets compiled in, using the logLevel numbers
+// (0 FATAL ... 5 TRACE). Calls past it are removed by the preprocessor,
+// arguments included. Release builds stop at INFO.
+#ifndef LOG_MIN_LEVEL
 #if FSNRELEASE == 1
-#define LOG_DEBUG_ENABLED 0
-#define LOG_TRACE_ENABLED 0
+#define LOG_MIN_LEVEL 3
+#else
+#define LOG_MIN_LEVEL 5
+#endif
+#endif
+
+#define LOG_WARN_ENABLED (LOG_MIN_LEVEL >= 2)
+#define LOG_INFO_ENABLED (LOG_MIN_LEVEL >= 3)
+#define LOG_DEBUG_ENABLED (LOG_MIN_LEVEL >= 4)
+#define LOG_TRACE_ENABLED (LOG_MIN_LEVEL >= 5)
+
+// Max messages per second a single call site may log before the rest of that
+// second is dropped. 0 turns the limiter off. FATAL is never limited.
+#ifndef LOG_RATE_LIMIT
+#define LOG_RATE_LIMIT 100
+#endif
+
+// Send FDEBUG/FTRACE through the binary log (core/logBinary.h) instead of
+// formatting them. Decode appLogger.blog with tools/logDecoder.
+#ifndef LOG_BINARY_ENABLED
+#define LOG_BINARY_ENABLED 0
+#endif
+
+#if LOG_BINARY_ENABLED == 1
+#include "core/logBinary.h"
 #endif
 
 typedef enum logLevel {
@@ -22,48 +46,119 @@ typedef enum logLevel {
     LOG_LEVEL_TRACE = 5
 } logLevel;
 
+/**
+ * @brief Opens the log file and starts the background writer. Until this is
+ * called (and after loggerShutdown) entries are written on the calling thread
+ * and only go to the console.
+ */
 b8 loggerInit(u64* memoryRequirement, void* state);
+
+/**
+ * @brief Stops the writer, writes out whatever is still queued and closes the
+ * log file.
+ */
 void loggerShutdown();
 
+/**
+ * @brief Blocks until every entry logged so far has been written and flushed.
+ * FATAL entries do this on their own.
+ */
+CT_API void loggerFlush();
+
 CT_API void logToFile(logLevel level, b8 logToConsole, const char* message, ...);
 
 CT_API void logOutput(logLevel level, const char* message, ...);
 
+CT_API void logOutputV(logLevel level, const char* message, va_list args);
+
+// Per call site state for the rate limiter. Lives in a static at the site.
+typedef struct logRateLimit {
+    // Second the counts belong to
+    _Atomic u32 window;
+    _Atomic u32 count;
+    _Atomic u32 suppressed;
+} logRateLimit;
+
+/**
+ * @brief Counts a message against the site's limit. The first message of a new
+ * second also logs how many were dropped in the last one.
+ * @returns true if the message should be logged
+ */
+CT_API b8 logRateLimitAllow(logRateLimit* limit, u32 perSecond, logLevel level,
+                            const char* file, i32 line);
+
+// Logs at most perSecond messages per second from this call site.
+#define FSN_LOG_LIMITED(level, perSecond, message, ...)                        \
+    do {                                                                       \
+        static logRateLimit logLimit;                                          \
+        if (logRateLimitAllow(&logLimit, perSecond, level, __FILE__,          \
+                              __LINE__)) {                                     \
+            logOutput(level, message, ##__VA_ARGS__);                          \
+        }                                                                      \
+    } while (0)
+
+#if LOG_RATE_LIMIT > 0
+#define FSN_LOG(level, message, ...)                                           \
+    FSN_LOG_LIMITED(level, LOG_RATE_LIMIT, message, ##__VA_ARGS__)
+#else
+#define FSN_LOG(level, message, ...) logOutput(level, message, ##__VA_ARGS__)
+#endif
+
 // Logs a fatal-level message.
 #define FFATAL(message, ...) logOutput(LOG_LEVEL_FATAL, message, ##__VA_ARGS__);
 
 #ifndef FERROR
 // Logs an error-level message.
-#define FERROR(message, ...) logOutput(LOG_LEVEL_ERROR, message, ##__VA_ARGS__);
+#define FERROR(message, ...) FSN_LOG(LOG_LEVEL_ERROR, message, ##__VA_ARGS__);
 #endif
 
+// Logs an error-level message, at most perSecond times a second from this
+// call site. For errors that can repeat every frame.
+#define FERROR_LIMITED(perSecond, message, ...)                                \
+    FSN_LOG_LIMITED(LOG_LEVEL_ERROR, perSecond, message, ##__VA_ARGS__);
+
 #if LOG_WARN_ENABLED == 1
 // Logs a warning-level message.
-#define FWARN(message, ...) logOutput(LOG_LEVEL_WARN, message, ##__VA_ARGS__);
+#define FWARN(message, ...) FSN_LOG(LOG_LEVEL_WARN, message, ##__VA_ARGS__);
 #else
 // Does nothing when LOG_WARN_ENABLED is false
 #define FWARN(message, ...)
 #endif
 
+#if LOG_WARN_ENABLED == 1
+// Logs a warning-level message, at most perSecond times a second from this
+// call site.
+#define FWARN_LIMITED(perSecond, message, ...)                                 \
+    FSN_LOG_LIMITED(LOG_LEVEL_WARN, perSecond, message, ##__VA_ARGS__);
+#else
+#define FWARN_LIMITED(perSecond, message, ...)
+#endif
+
 #if LOG_INFO_ENABLED == 1
 // Logs a info-level message.
-#define FINFO(message, ...) logOutput(LOG_LEVEL_INFO, message, ##__VA_ARGS__);
+#define FINFO(message, ...) FSN_LOG(LOG_LEVEL_INFO, message, ##__VA_ARGS__);
 #else
 // Does nothing when LOG_INFO_ENABLED is false
 #define FINFO(message, ...)
 #endif
 
-#if LOG_DEBUG_ENABLED == 1
+#if LOG_DEBUG_ENABLED == 1 && LOG_BINARY_ENABLED == 1
+// Logs a debug-level message to the binary log.
+#define FDEBUG(message, ...) FSN_LOG_BINARY(LOG_LEVEL_DEBUG, message, ##__VA_ARGS__);
+#elif LOG_DEBUG_ENABLED == 1
 // Logs a debug-level message.
-#define FDEBUG(message, ...) logOutput(LOG_LEVEL_DEBUG, message, ##__VA_ARGS__);
+#define FDEBUG(message, ...) FSN_LOG(LOG_LEVEL_DEBUG, message, ##__VA_ARGS__);
 #else
 // Does nothing when LOG_DEBUG_ENABLED is false
 #define FDEBUG(message, ...)
 #endif
 
-#if LOG_TRACE_ENABLED == 1
+#if LOG_TRACE_ENABLED == 1 && LOG_BINARY_ENABLED == 1
+// Logs a trace-level message to the binary log.
+#define FTRACE(message, ...) FSN_LOG_BINARY(LOG_LEVEL_TRACE, message, ##__VA_ARGS__);
+#elif LOG_TRACE_ENABLED == 1
 // Logs a trace-level message.
-#define FTRACE(message, ...) logOutput(LOG_LEVEL_TRACE, message, ##__VA_ARGS__);
+#define FTRACE(message, ...) FSN_LOG(LOG_LEVEL_TRACE, message, ##__VA_ARGS__);
 #else
 // Does nothing when LOG_TRACE_ENABLED is false
 #define FTRACE(message, ...)
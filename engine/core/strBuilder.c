@@ -0,0 +1,147 @@
+#include "strBuilder.h"
+
+#include "core/fmemory.h"
+
+#include <stdio.h>
+
+// First heap allocation size for builders that started without a buffer
+#define STR_BUILDER_MIN_CAPACITY 64
+
+void strBuilderInit(strBuilder* sb, char* buffer, u64 bufferSize) {
+    sb->data = bufferSize ? buffer : 0;
+    sb->len = 0;
+    sb->capacity = buffer ? bufferSize : 0;
+    sb->ownsMemory = false;
+    sb->fixed = false;
+    sb->truncated = false;
+    if (sb->capacity) {
+        sb->data[0] = 0;
+    }
+}
+
+void strBuilderInitFixed(strBuilder* sb, char* buffer, u64 bufferSize) {
+    strBuilderInit(sb, buffer, bufferSize);
+    sb->fixed = true;
+}
+
+b8 strBuilderCreate(strBuilder* sb, u64 capacity) {
+    strBuilderInit(sb, 0, 0);
+    return strBuilderReserve(sb, capacity);
+}
+
+void strBuilderDestroy(strBuilder* sb) {
+    if (sb->ownsMemory) {
+        ffree(sb->data, sb->capacity, MEMORY_TAG_STRING);
+    }
+    strBuilderInit(sb, 0, 0);
+}
+
+void strBuilderReset(strBuilder* sb) {
+    sb->len = 0;
+    sb->truncated = false;
+    if (sb->capacity) {
+        sb->data[0] = 0;
+    }
+}
+
+b8 strBuilderReserve(strBuilder* sb, u64 extra) {
+    u64 needed = sb->len + extra + 1;
+    if (needed <= sb->capacity) {
+        return true;
+    }
+    if (sb->fixed) {
+        return false;
+    }
+
+    u64 newCapacity =
+        sb->capacity ? sb->capacity * 2 : STR_BUILDER_MIN_CAPACITY;
+    while (newCapacity < needed) {
+        newCapacity *= 2;
+    }
+
+    char* newData = fallocate(newCapacity, MEMORY_TAG_STRING);
+    if (!newData) {
+        return false;
+    }
+    if (sb->capacity) {
+        fcopyMemory(newData, sb->data, sb->len + 1);
+    }
+    if (sb->ownsMemory) {
+        ffree(sb->data, sb->capacity, MEMORY_TAG_STRING);
+    }
+
+    sb->data = newData;
+    sb->capacity = newCapacity;
+    sb->ownsMemory = true;
+    return true;
+}
+
+void strBuilderAppendN(strBuilder* sb, const char* str, u64 len) {
+    if (!strBuilderReserve(sb, len)) {
+        // Keep whatever still fits
+        sb->truncated = true;
+        if (sb->capacity == 0) {
+            return;
+        }
+        len = sb->capacity - 1 - sb->len;
+    }
+    fcopyMemory(sb->data + sb->len, str, len);
+    sb->len += len;
+    sb->data[sb->len] = 0;
+}
+
+void strBuilderAppend(strBuilder* sb, const char* str) {
+    strBuilderAppendN(sb, str, strLen(str));
+}
+
+void strBuilderAppendView(strBuilder* sb, strView v) {
+    strBuilderAppendN(sb, v.ptr, v.len);
+}
+
+void strBuilderAppendChar(strBuilder* sb, char c) {
+    strBuilderAppendN(sb, &c, 1);
+}
+
+void strBuilderAppendFmtV(strBuilder* sb, const char* format, va_list args) {
+    // Format straight into the free space first. Only if it didn't fit grow
+    // to the exact size vsnprintf reported and do it again.
+    va_list retry;
+    va_copy(retry, args);
+
+    u64 space = sb->capacity ? sb->capacity - sb->len : 0;
+    i32 written = vsnprintf(space ? sb->data + sb->len : 0, space, format, args);
+    if (written < 0) {
+        va_end(retry);
+        if (space) {
+            sb->data[sb->len] = 0;
+        }
+        return;
+    }
+
+    if ((u64)written >= space) {
+        if (strBuilderReserve(sb, written)) {
+            vsnprintf(sb->data + sb->len, written + 1, format, retry);
+        } else {
+            // vsnprintf already wrote whatever fit into the old space
+            sb->truncated = true;
+            written = space ? space - 1 : 0;
+        }
+    }
+    va_end(retry);
+    sb->len += written;
+}
+
+void strBuilderAppendFmt(strBuilder* sb, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    strBuilderAppendFmtV(sb, format, args);
+    va_end(args);
+}
+
+const char* strBuilderCStr(const strBuilder* sb) {
+    return sb->capacity ? sb->data : "";
+}
+
+strView strBuilderView(const strBuilder* sb) {
+    return strViewMake(strBuilderCStr(sb), sb->len);
+}
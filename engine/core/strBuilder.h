@@ -0,0 +1,89 @@
+#pragma once
+
+#include "core/fstring.h"
+#include "defines.h"
+
+#include <stdarg.h>
+
+/**
+ *  Growable string buffer for building paths/messages piece by piece.
+ *  The builder remembers its length so appending never re-scans what is
+ * already there, and the data is always null terminated.
+ *  It can start out on a caller supplied buffer (usually on the stack) and only
+ * moves to the heap (fallocate, MEMORY_TAG_STRING) once that runs out. Growth
+ * doubles the capacity so appends are amortized O(1).
+ *  strBuilderReset keeps the memory around, so a long lived builder can be
+ * reused as a scratch arena without allocating again.
+ *
+ *  If an allocation fails the builder stops growing and truncates instead,
+ * `truncated` is set so the caller can tell.
+ */
+
+typedef struct strBuilder {
+    char* data;
+    // Amount of chars, not counting the null terminator
+    u64 len;
+    // Total size of data, including room for the null terminator
+    u64 capacity;
+    // false while data still points at the caller supplied buffer
+    b8 ownsMemory;
+    // Never leaves the caller supplied buffer, see strBuilderInitFixed
+    b8 fixed;
+    b8 truncated;
+} strBuilder;
+
+/**
+ * @brief Starts a builder on top of buffer. Nothing is allocated until buffer
+ * is full.
+ * @param sb The builder
+ * @param buffer Initial storage, can be 0
+ * @param bufferSize Size of buffer in bytes
+ */
+CT_API void strBuilderInit(strBuilder* sb, char* buffer, u64 bufferSize);
+
+/**
+ * @brief Starts a builder that never allocates and truncates once buffer is
+ * full. For code that can't touch fmemory, e.g. off the main thread.
+ */
+CT_API void strBuilderInitFixed(strBuilder* sb, char* buffer, u64 bufferSize);
+
+/**
+ * @brief Starts a builder with capacity bytes allocated up front.
+ */
+CT_API b8 strBuilderCreate(strBuilder* sb, u64 capacity);
+
+/**
+ * @brief Frees the heap memory (if any). The builder can be reused after
+ * another Init/Create.
+ */
+CT_API void strBuilderDestroy(strBuilder* sb);
+
+/**
+ * @brief Sets the length back to 0 but keeps the memory.
+ */
+CT_API void strBuilderReset(strBuilder* sb);
+
+/**
+ * @brief Makes sure `extra` more chars fit without another allocation.
+ * @returns false if the memory couldn't be allocated
+ */
+CT_API b8 strBuilderReserve(strBuilder* sb, u64 extra);
+
+CT_API void strBuilderAppend(strBuilder* sb, const char* str);
+CT_API void strBuilderAppendN(strBuilder* sb, const char* str, u64 len);
+CT_API void strBuilderAppendView(strBuilder* sb, strView v);
+CT_API void strBuilderAppendChar(strBuilder* sb, char c);
+
+/**
+ * @brief printf style append straight into the builder's memory.
+ */
+CT_API void strBuilderAppendFmt(strBuilder* sb, const char* format, ...);
+CT_API void strBuilderAppendFmtV(strBuilder* sb, const char* format,
+                                 va_list args);
+
+/**
+ * @brief The built string. Only valid until the next append.
+ */
+CT_API const char* strBuilderCStr(const strBuilder* sb);
+
+CT_API strView strBuilderView(const strBuilder* sb);
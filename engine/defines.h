@@ -69,6 +69,10 @@ STATIC_ASSERT(sizeof(f64) == 8, "Expected f64 to be 8 bytes.");
 #define MEBIBYTES(amount) amount * 1024 * 1024
 #define KIBIBYTES(amount) amount * 1024
 
+// Size of a cache line on every platform we currently target. Used to pad
+// data that is written by different threads so it doesn't false share.
+#define FSN_CACHE_LINE_SIZE 64
+
 // I know I took this from somewhere. Can't find it again
 //Platform detection
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) 
@@ -117,6 +121,25 @@ STATIC_ASSERT(sizeof(f64) == 8, "Expected f64 to be 8 bytes.");
 #define FSN_NOINLINE
 #endif
 
+// Thread local storage
+#ifdef _MSC_VER
+#define FSN_THREAD_LOCAL __declspec(thread)
+#else
+#define FSN_THREAD_LOCAL _Thread_local
+#endif
+
+// Tells the CPU it's in a spin-wait loop
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define FSN_CPU_RELAX() _mm_pause()
+#elif defined(__x86_64__) || defined(__i386__)
+#define FSN_CPU_RELAX() __builtin_ia32_pause()
+#elif defined(__aarch64__)
+#define FSN_CPU_RELAX() __asm__ __volatile__("yield")
+#else
+#define FSN_CPU_RELAX()
+#endif
+
 #ifdef FSN_EXPORT
 //Exports
 #ifdef _MSC_VER
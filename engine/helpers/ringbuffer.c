@@ -0,0 +1,297 @@
+#include "ringbuffer.h"
+
+#include "core/fmemory.h"
+#include "core/logger.h"
+
+#include <stdatomic.h>
+
+/*
+ * SPSC is the classic Lamport ring with each side caching the other side's
+ * index so it only touches the shared cache line when it thinks the ring is
+ * full/empty.
+ * MPMC is Dmitry Vyukov's bounded queue. Every cell carries a sequence number
+ * that tells producers/consumers whose turn it is, so a single CAS on the
+ * enqueue/dequeue position is all that is needed.
+ *
+ * fallocate doesn't align anything, so every ring over-allocates by a cache
+ * line and aligns the state itself. That keeps the atomics naturally aligned
+ * and the padding below actually lands on separate cache lines.
+ */
+
+#define ALIGN_UP(value, alignment)                                             \
+    (((value) + ((alignment)-1)) & ~((u64)(alignment)-1))
+
+typedef struct spscState {
+    // Only written by the producer
+    _Atomic u64 tail;
+    u64 cachedHead;
+    u8 producerPad[FSN_CACHE_LINE_SIZE - sizeof(u64) * 2];
+
+    // Only written by the consumer
+    _Atomic u64 head;
+    u64 cachedTail;
+    u8 consumerPad[FSN_CACHE_LINE_SIZE - sizeof(u64) * 2];
+
+    // Read only after creation
+    u64 mask;
+    u64 stride;
+    u64 blockSize;
+    void* block;
+    u8* data;
+} spscState;
+
+typedef struct mpmcCell {
+    _Atomic u64 sequence;
+    // Element data follows directly after
+} mpmcCell;
+
+typedef struct mpmcState {
+    _Atomic u64 enqueuePos;
+    u8 enqueuePad[FSN_CACHE_LINE_SIZE - sizeof(u64)];
+
+    _Atomic u64 dequeuePos;
+    u8 dequeuePad[FSN_CACHE_LINE_SIZE - sizeof(u64)];
+
+    // Read only after creation
+    u64 mask;
+    u64 stride;
+    u64 cellStride;
+    u64 blockSize;
+    void* block;
+    u8* cells;
+} mpmcState;
+
+static u64 roundUpPow2(u64 v) {
+    u64 r = 1;
+    while (r < v) {
+        r <<= 1;
+    }
+    return r;
+}
+
+// Allocates size bytes plus enough slack to hand back a cache line aligned
+// pointer. The raw block is written to outBlock so it can be freed later.
+static void* allocateAligned(u64 size, void** outBlock) {
+    void* block = fallocate(size + FSN_CACHE_LINE_SIZE, MEMORY_TAG_ARRAY);
+    if (!block) {
+        return 0;
+    }
+    *outBlock = block;
+    return (void*)ALIGN_UP((u64)block, FSN_CACHE_LINE_SIZE);
+}
+
+//====================== SPSC ======================
+
+b8 spscRingCreate(u64 elementStride, u32 capacity, spscRing* outRing) {
+    if (!outRing || elementStride == 0 || capacity == 0) {
+        FERROR("spscRingCreate needs a ring, a stride and a capacity above 0.");
+        return false;
+    }
+
+    u64 cap = roundUpPow2(capacity);
+    u64 stateSize = ALIGN_UP(sizeof(spscState), FSN_CACHE_LINE_SIZE);
+    u64 total = stateSize + cap * elementStride;
+
+    void* block = 0;
+    spscState* state = allocateAligned(total, &block);
+    if (!state) {
+        return false;
+    }
+
+    state->mask = cap - 1;
+    state->stride = elementStride;
+    state->blockSize = total + FSN_CACHE_LINE_SIZE;
+    state->block = block;
+    state->data = (u8*)state + stateSize;
+    state->cachedHead = 0;
+    state->cachedTail = 0;
+    atomic_init(&state->head, 0);
+    atomic_init(&state->tail, 0);
+
+    outRing->memory = state;
+    return true;
+}
+
+void spscRingDestroy(spscRing* ring) {
+    if (ring && ring->memory) {
+        spscState* state = ring->memory;
+        ffree(state->block, state->blockSize, MEMORY_TAG_ARRAY);
+        ring->memory = 0;
+    }
+}
+
+b8 spscRingPush(spscRing* ring, const void* value) {
+    spscState* state = ring->memory;
+    u64 tail = atomic_load_explicit(&state->tail, memory_order_relaxed);
+
+    if (tail - state->cachedHead > state->mask) {
+        // Looks full, go check what the consumer has actually done.
+        state->cachedHead =
+            atomic_load_explicit(&state->head, memory_order_acquire);
+        if (tail - state->cachedHead > state->mask) {
+            return false;
+        }
+    }
+
+    fcopyMemory(state->data + (tail & state->mask) * state->stride, value,
+                state->stride);
+    atomic_store_explicit(&state->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+b8 spscRingPop(spscRing* ring, void* outValue) {
+    spscState* state = ring->memory;
+    u64 head = atomic_load_explicit(&state->head, memory_order_relaxed);
+
+    if (head == state->cachedTail) {
+        // Looks empty, go check what the producer has actually done.
+        state->cachedTail =
+            atomic_load_explicit(&state->tail, memory_order_acquire);
+        if (head == state->cachedTail) {
+            return false;
+        }
+    }
+
+    fcopyMemory(outValue, state->data + (head & state->mask) * state->stride,
+                state->stride);
+    atomic_store_explicit(&state->head, head + 1, memory_order_release);
+    return true;
+}
+
+u32 spscRingLength(spscRing* ring) {
+    spscState* state = ring->memory;
+    u64 tail = atomic_load_explicit(&state->tail, memory_order_acquire);
+    // head can pass the tail read above if the consumer pops in between
+    u64 head = atomic_load_explicit(&state->head, memory_order_acquire);
+    return tail > head ? (u32)(tail - head) : 0;
+}
+
+u32 spscRingCapacity(spscRing* ring) {
+    spscState* state = ring->memory;
+    return (u32)(state->mask + 1);
+}
+
+//====================== MPMC ======================
+
+static mpmcCell* mpmcCellAt(mpmcState* state, u64 pos) {
+    return (mpmcCell*)(state->cells + (pos & state->mask) * state->cellStride);
+}
+
+b8 mpmcRingCreate(u64 elementStride, u32 capacity, mpmcRing* outRing) {
+    if (!outRing || elementStride == 0 || capacity == 0) {
+        FERROR("mpmcRingCreate needs a ring, a stride and a capacity above 0.");
+        return false;
+    }
+
+    // Need at least 2 cells or the sequence numbers can't tell full from empty
+    u64 cap = roundUpPow2(capacity < 2 ? 2 : capacity);
+    u64 stateSize = ALIGN_UP(sizeof(mpmcState), FSN_CACHE_LINE_SIZE);
+    u64 cellStride = ALIGN_UP(sizeof(mpmcCell) + elementStride, sizeof(u64));
+    u64 total = stateSize + cap * cellStride;
+
+    void* block = 0;
+    mpmcState* state = allocateAligned(total, &block);
+    if (!state) {
+        return false;
+    }
+
+    state->mask = cap - 1;
+    state->stride = elementStride;
+    state->cellStride = cellStride;
+    state->blockSize = total + FSN_CACHE_LINE_SIZE;
+    state->block = block;
+    state->cells = (u8*)state + stateSize;
+    atomic_init(&state->enqueuePos, 0);
+    atomic_init(&state->dequeuePos, 0);
+
+    for (u64 i = 0; i < cap; i++) {
+        atomic_init(&mpmcCellAt(state, i)->sequence, i);
+    }
+
+    outRing->memory = state;
+    return true;
+}
+
+void mpmcRingDestroy(mpmcRing* ring) {
+    if (ring && ring->memory) {
+        mpmcState* state = ring->memory;
+        ffree(state->block, state->blockSize, MEMORY_TAG_ARRAY);
+        ring->memory = 0;
+    }
+}
+
+b8 mpmcRingPush(mpmcRing* ring, const void* value) {
+    mpmcState* state = ring->memory;
+    mpmcCell* cell;
+    u64 pos = atomic_load_explicit(&state->enqueuePos, memory_order_relaxed);
+
+    for (;;) {
+        cell = mpmcCellAt(state, pos);
+        u64 seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        i64 diff = (i64)seq - (i64)pos;
+        if (diff == 0) {
+            // Cell is free for this lap. Try to claim it.
+            if (atomic_compare_exchange_weak_explicit(
+                    &state->enqueuePos, &pos, pos + 1, memory_order_relaxed,
+                    memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Consumer hasn't freed this cell yet. Full.
+            return false;
+        } else {
+            // Another producer got here first
+            pos = atomic_load_explicit(&state->enqueuePos,
+                                       memory_order_relaxed);
+        }
+    }
+
+    fcopyMemory((u8*)cell + sizeof(mpmcCell), value, state->stride);
+    atomic_store_explicit(&cell->sequence, pos + 1, memory_order_release);
+    return true;
+}
+
+b8 mpmcRingPop(mpmcRing* ring, void* outValue) {
+    mpmcState* state = ring->memory;
+    mpmcCell* cell;
+    u64 pos = atomic_load_explicit(&state->dequeuePos, memory_order_relaxed);
+
+    for (;;) {
+        cell = mpmcCellAt(state, pos);
+        u64 seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        i64 diff = (i64)seq - (i64)(pos + 1);
+        if (diff == 0) {
+            // Cell has been published. Try to claim it.
+            if (atomic_compare_exchange_weak_explicit(
+                    &state->dequeuePos, &pos, pos + 1, memory_order_relaxed,
+                    memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Producer hasn't written this cell yet. Empty.
+            return false;
+        } else {
+            // Another consumer got here first
+            pos = atomic_load_explicit(&state->dequeuePos,
+                                       memory_order_relaxed);
+        }
+    }
+
+    fcopyMemory(outValue, (u8*)cell + sizeof(mpmcCell), state->stride);
+    // Mark the cell free for the producers' next lap
+    atomic_store_explicit(&cell->sequence, pos + state->mask + 1,
+                          memory_order_release);
+    return true;
+}
+
+u32 mpmcRingLength(mpmcRing* ring) {
+    mpmcState* state = ring->memory;
+    u64 enq = atomic_load_explicit(&state->enqueuePos, memory_order_acquire);
+    u64 deq = atomic_load_explicit(&state->dequeuePos, memory_order_acquire);
+    return enq > deq ? (u32)(enq - deq) : 0;
+}
+
+u32 mpmcRingCapacity(mpmcRing* ring) {
+    mpmcState* state = ring->memory;
+    return (u32)(state->mask + 1);
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "defines.h"
+
+/**
+ *  Fixed-capacity lock-free ring buffers.
+ *  spscRing: exactly one producer thread and one consumer thread.
+ *  mpmcRing: any number of producers and consumers (bounded, no blocking).
+ *  Capacity is always rounded up to a power of 2. Elements are copied in and
+ * out by value so `elementStride` should be kept small (pointers/handles/small
+ * structs).
+ */
+
+typedef struct spscRing {
+    void* memory;
+} spscRing;
+
+typedef struct mpmcRing {
+    void* memory;
+} mpmcRing;
+
+/**
+ * @brief Creates a single producer/single consumer ring buffer. The memory is
+ * allocated through fallocate.
+ * @param elementStride Size of a single element
+ * @param capacity Max amount of elements. Rounded up to a power of 2
+ * @param outRing The ring to be created
+ * @returns true if successful, false if failed
+ */
+CT_API b8 spscRingCreate(u64 elementStride, u32 capacity, spscRing* outRing);
+CT_API void spscRingDestroy(spscRing* ring);
+
+/**
+ * @brief Copies value into the ring. Only call from the producer thread.
+ * @returns false if the ring is full
+ */
+CT_API b8 spscRingPush(spscRing* ring, const void* value);
+
+/**
+ * @brief Copies the oldest element into outValue. Only call from the consumer
+ * thread.
+ * @returns false if the ring is empty
+ */
+CT_API b8 spscRingPop(spscRing* ring, void* outValue);
+
+/**
+ * @brief Approximate amount of elements in the ring. Exact when called from
+ * the producer or consumer thread while the other is idle.
+ */
+CT_API u32 spscRingLength(spscRing* ring);
+CT_API u32 spscRingCapacity(spscRing* ring);
+
+/**
+ * @brief Creates a bounded multi producer/multi consumer ring buffer. The
+ * memory is allocated through fallocate.
+ * @param elementStride Size of a single element
+ * @param capacity Max amount of elements. Rounded up to a power of 2
+ * @param outRing The ring to be created
+ * @returns true if successful, false if failed
+ */
+CT_API b8 mpmcRingCreate(u64 elementStride, u32 capacity, mpmcRing* outRing);
+CT_API void mpmcRingDestroy(mpmcRing* ring);
+
+/**
+ * @brief Copies value into the ring. Safe to call from any thread.
+ * @returns false if the ring is full
+ */
+CT_API b8 mpmcRingPush(mpmcRing* ring, const void* value);
+
+/**
+ * @brief Copies the oldest element into outValue. Safe to call from any
+ * thread.
+ * @returns false if the ring is empty
+ */
+CT_API b8 mpmcRingPop(mpmcRing* ring, void* outValue);
+
+/**
+ * @brief Approximate amount of elements in the ring.
+ */
+CT_API u32 mpmcRingLength(mpmcRing* ring);
+CT_API u32 mpmcRingCapacity(mpmcRing* ring);
@@ -1,16 +1,27 @@
 #include "core/event.h"
+#include "core/fixedTimestep.h"
 #include "core/fmemory.h"
+#include "core/fstring.h"
+#include "core/frameTimer.h"
+#include "core/fstringSimd.h"
 #include "core/input.h"
+#include "core/inputLatency.h"
+#include "core/inputRecord.h"
 #include "core/logger.h"
 #include "defines.h"
+#include "math/fsnmath.h"
 #include "platform/platform.h"
 #include "renderer/renderer.h"
 #include "resources/resourceManager.h"
+#include "systems/jobSystem.h"
 #include "systems/shaderSystem.h"
+#include "systems/taskGraph.h"
 #include <stdint.h>
 
 #define APP_WIDTH 1280
 #define APP_HEIGHT 720
+// Radians per second the quad turns
+#define SPIN_SPEED 1.0f
 
 // TODO: Move to renderer's abstraction layer
 
@@ -25,6 +36,9 @@ typedef struct App {
     u64 resourceManagerMemReq;
     void* resourceManagerState;
 
+    u64 loggerMemReq;
+    void* loggerState;
+
     u64 eventMemReq;
     void* eventState;
 
@@ -36,6 +50,19 @@ typedef struct App {
 
     u64 shaderSystemMemReq;
     void* shaderSystemState;
+
+    u64 jobSystemMemReq;
+    void* jobSystemState;
+
+    taskGraph frameGraph;
+    // The packet the current frame is building
+    renderPacket* packet;
+    // Simulation ticks the current frame runs
+    u32 ticks;
+
+    // Simulated state, as of the last two ticks
+    f32 spinPrev;
+    f32 spinCur;
 } App;
 
 static App* app;
@@ -52,20 +79,113 @@ b8 appResized(u16 code, void* sender, void* listenerInst, eventContext ec){
     app->width = width;
     app->height = height;
 
-    if (width == 0 || height == 0){
-        // TODO: Window is minimized
-        return true;
-    }else{
-        // TODO: Renderer abstracted onResize FN
-        rendererOnResized(width, height);
+    // A zero size (some window managers minimize that way) stops the frame
+    // loop until the window is back, see appIsHidden. Otherwise the
+    // renderer picks the new size up from the next frame's packet.
+    return false;
+}
+
+// Nothing of the window can be seen, so there's no point drawing it
+static b8 appIsHidden() {
+    return (platformGetWindowState() & (PLATFORM_WINDOW_MINIMIZED | PLATFORM_WINDOW_OCCLUDED)) ||
+           app->width == 0 || app->height == 0;
+}
+
+/*
+ * Frame tasks. With a render thread the frame ends once its packet is built
+ * and handed over, drawing it overlaps the next frame:
+ *
+ *   input -> simulation -> build -> handOff
+ *
+ * Without one the frame draws its own packet. Acquiring the next image only
+ * waits on the GPU, so it runs next to input and simulation:
+ *
+ *   input -> simulation -> build --+
+ *                                  +--> record -> submit
+ *   acquire -----------------------+
+ */
+
+static void inputTask(void* data) {
+    platformPumpMessages();
+    inputRecordFrame();
+    // Everything the OS handed us this frame, in one batch.
+    eventDispatchQueued();
+    inputLatencyFrameObserved();
+}
+
+static void simulationTask(void* data) {
+    f64 dt = fixedTimestepDelta();
+    for (u32 i = 0; i < app->ticks; i++) {
+        app->spinPrev = app->spinCur;
+        app->spinCur += SPIN_SPEED * (f32)dt;
+        // Edges are seen by the first tick after them, even if a frame runs
+        // none.
+        inputUpdate(dt);
     }
+}
 
-    return false;
+static void buildTask(void* data) {
+    renderPacket* packet = app->packet;
+    packet->view = mat4Identity();
+    packet->projection = mat4Identity();
+    packet->draws = rendererPacketAllocate(packet, sizeof(renderDrawCmd));
+    if (packet->draws) {
+        f32 spin = app->spinPrev + (app->spinCur - app->spinPrev) * packet->alpha;
+        packet->draws[0].model = mat4EulerZ(spin);
+        packet->drawCount = 1;
+    }
+}
+
+static void handOffTask(void* data) {
+    rendererSubmitPacket(app->packet);
+}
+
+static void acquireTask(void* data) {
+    rendererBeginFrame(app->packet);
+}
+
+static void recordTask(void* data) {
+    rendererRecord(app->packet);
 }
 
-int main(void) {
+static void submitTask(void* data) {
+    rendererEndFrame(app->packet);
+}
+
+static b8 buildFrameGraph(taskGraph* graph, b8 renderThread) {
+    u32 input, simulation, build;
+    if (!taskGraphCreate(graph) ||
+        !taskGraphAddNode(graph, "input", inputTask, 0, TASK_FLAG_MAIN_THREAD, &input) ||
+        !taskGraphAddNode(graph, "simulation", simulationTask, 0, TASK_FLAG_NONE, &simulation) ||
+        !taskGraphAddNode(graph, "build", buildTask, 0, TASK_FLAG_NONE, &build) ||
+        !taskGraphAddDependency(graph, input, simulation) ||
+        !taskGraphAddDependency(graph, simulation, build)) {
+        return false;
+    }
+
+    if (renderThread) {
+        u32 handOff;
+        return taskGraphAddNode(graph, "handOff", handOffTask, 0, TASK_FLAG_NONE, &handOff) &&
+               taskGraphAddDependency(graph, build, handOff) &&
+               taskGraphCompile(graph);
+    }
+    u32 acquire, record, submit;
+    return taskGraphAddNode(graph, "acquire", acquireTask, 0, TASK_FLAG_NONE, &acquire) &&
+           taskGraphAddNode(graph, "record", recordTask, 0, TASK_FLAG_NONE, &record) &&
+           taskGraphAddNode(graph, "submit", submitTask, 0, TASK_FLAG_NONE, &submit) &&
+           taskGraphAddDependency(graph, build, record) &&
+           taskGraphAddDependency(graph, acquire, record) &&
+           taskGraphAddDependency(graph, record, submit) &&
+           taskGraphCompile(graph);
+}
+
+int main(int argc, char** argv) {
     FINFO("Hello There.\n");
 
+    // Pick the string kernels before anything starts parsing
+    strSimdInit();
+    FDEBUG("String kernels: %s", strSimdName());
+
     memorySystemSettings memorySettings;
     memorySettings.totalSize = GIGABYTES(1);
     memoryInit(memorySettings);
@@ -73,6 +193,10 @@ int main(void) {
     app = fallocate(sizeof(App), MEMORY_TAG_APPLICATION);
     app->shouldQuit = 0;
 
+    loggerInit(&app->loggerMemReq, 0);
+    app->loggerState = fallocate(app->loggerMemReq, MEMORY_TAG_APPLICATION);
+    loggerInit(&app->loggerMemReq, app->loggerState);
+
     eventInit(&app->eventMemReq, 0);
     app->eventState = fallocate(app->eventMemReq, MEMORY_TAG_UNKNOWN);
     eventInit(&app->eventMemReq, app->eventState);
@@ -84,13 +208,67 @@ int main(void) {
     app->inputState = fallocate(app->inputMemReq, MEMORY_TAG_UNKNOWN);
     inputInit(&app->inputMemReq, app->inputState);
 
+    // --headless runs without a window on synthetic input and renders
+    // offscreen, --frames <n> quits after n frames. Together they're for
+    // CI and benchmark runs on machines without a display.
+    // --fps <n> caps the frame rate, 0 (the default) runs uncapped.
+    // --workers <n> sets the job threads next to the main one, one per
+    // remaining CPU by default.
+    // --render-thread draws on a thread of its own, a frame behind.
+    // --tick-rate <n> runs the simulation n times a second (60), and a frame
+    // runs at most --max-ticks <n> of them (5) however far behind it is.
+    // --background-fps <n> caps the frame rate while the window isn't
+    // focused (10), 0 leaves it at --fps.
+    b8 headless = false;
+    b8 renderThread = false;
+    f64 tickRate = 60;
+    u64 maxTicks = 5;
+    u64 maxFrames = 0;
+    f64 targetFps = 0;
+    f64 backgroundFps = 10;
+    u64 workers = INVALID_ID;
+    for (i32 i = 1; i < argc; i++) {
+        if (strEqual(argv[i], "--headless")) {
+            headless = true;
+        } else if (strEqual(argv[i], "--frames") && i + 1 < argc) {
+            strToU64(argv[++i], &maxFrames);
+        } else if (strEqual(argv[i], "--fps") && i + 1 < argc) {
+            strToF64(argv[++i], &targetFps);
+        } else if (strEqual(argv[i], "--background-fps") && i + 1 < argc) {
+            strToF64(argv[++i], &backgroundFps);
+        } else if (strEqual(argv[i], "--tick-rate") && i + 1 < argc) {
+            strToF64(argv[++i], &tickRate);
+        } else if (strEqual(argv[i], "--max-ticks") && i + 1 < argc) {
+            strToU64(argv[++i], &maxTicks);
+        } else if (strEqual(argv[i], "--render-thread")) {
+            renderThread = true;
+        } else if (strEqual(argv[i], "--workers") && i + 1 < argc) {
+            strToU64(argv[++i], &workers);
+        }
+    }
+
     app->width = APP_WIDTH;
     app->height = APP_HEIGHT;
     app->platformMemReq = 0;
-    platformStartup(&app->platformMemReq, 0, "Triangle", 0, 0, APP_WIDTH, APP_HEIGHT);
+    platformStartup(&app->platformMemReq, 0, "Triangle", 0, 0, APP_WIDTH, APP_HEIGHT,
+                    headless);
     app->platformState = fallocate(app->platformMemReq, MEMORY_TAG_APPLICATION);
-    platformStartup(&app->platformMemReq, app->platformState, "Triangle", 0, 0,
-                    APP_WIDTH, APP_HEIGHT);
+    if (!platformStartup(&app->platformMemReq, app->platformState, "Triangle", 0, 0,
+                         APP_WIDTH, APP_HEIGHT, headless)) {
+        FFATAL("Platform startup failed.");
+        return 1;
+    }
+
+    jobSystemSettings jss;
+    jss.workerCount = (u32)workers;
+    jss.maxJobsPerWorker = 1024;
+    jss.pinWorkers = false;
+    jobSystemInit(&app->jobSystemMemReq, 0, jss);
+    app->jobSystemState = fallocate(app->jobSystemMemReq, MEMORY_TAG_APPLICATION);
+    if (!jobSystemInit(&app->jobSystemMemReq, app->jobSystemState, jss)) {
+        FFATAL("Job system startup failed.");
+        return 1;
+    }
 
     resourceManagerSettings resourceManagerSettings;
     resourceManagerSettings.maxManagers = 5;
@@ -100,9 +278,18 @@ int main(void) {
     resourceManagerInit(&app->resourceManagerMemReq, app->resourceManagerState, resourceManagerSettings);
 
 
-    rendererInit(&app->rendererMemReq, 0, "", APP_WIDTH, APP_HEIGHT);
+    rendererSettings rs;
+    rs.appName = "Triangle";
+    rs.width = APP_WIDTH;
+    rs.height = APP_HEIGHT;
+    rs.renderThread = renderThread;
+    rs.packetArenaSize = 64 * 1024;
+    rendererInit(&app->rendererMemReq, 0, rs);
     app->rendererState = fallocate(app->rendererMemReq, MEMORY_TAG_RENDERER);
-    rendererInit(&app->rendererMemReq, app->rendererState, "Triangle", APP_WIDTH, APP_HEIGHT);
+    if (!rendererInit(&app->rendererMemReq, app->rendererState, rs)) {
+        FFATAL("Renderer startup failed.");
+        return 1;
+    }
 
     shaderSystemSettings sss;
     sss.maxShaders = 100;
@@ -112,22 +299,88 @@ int main(void) {
 
     printMemoryUsage();
 
+    // --record <file> saves this run's input, --replay <file> runs on a
+    // saved one instead of live input and quits when it runs out.
+    for (i32 i = 1; i + 1 < argc; i++) {
+        if (strEqual(argv[i], "--record")) {
+            inputRecordStart(argv[++i]);
+        } else if (strEqual(argv[i], "--replay")) {
+            inputReplayStart(argv[++i]);
+        }
+    }
+
     u32 li = 0;
-    renderInfo ri;
-    ri.deltaTime = 100;
+    u64 frameCnt = 0;
+    if (!buildFrameGraph(&app->frameGraph, rendererIsThreaded())) {
+        FFATAL("Couldn't build the frame graph.");
+        return 1;
+    }
+    frameTimerInit(targetFps);
+    fixedTimestepInit(tickRate, (u32)maxTicks);
     while(!app->shouldQuit){
-        platformPumpMessages();
-        rendererDraw(&ri);
+        if (appIsHidden()) {
+            // Sleep until the window system has something to say instead of
+            // drawing frames nobody sees. Nothing simulates meanwhile, the
+            // first frame back starts from a zero delta.
+            frameTimerSkip();
+            platformWaitMessages(PLATFORM_WAIT_INFINITE);
+            platformPumpMessages();
+            eventDispatchQueued();
+            continue;
+        }
+        u64 frameStart = platformGetAbsoluteTimeNs();
+        f64 deltaTime = frameTimerTick();
+        if (maxFrames && frameCnt++ == maxFrames) {
+            FINFO("Ran %llu frames, quitting.", maxFrames);
+            break;
+        }
+        // Waits here if the render thread is a whole packet behind
+        app->packet = rendererAcquirePacket();
+        app->ticks = fixedTimestepAdvance(deltaTime);
+        app->packet->deltaTime = deltaTime;
+        app->packet->alpha = fixedTimestepAlpha();
+        app->packet->width = app->width;
+        app->packet->height = app->height;
+        taskGraphRun(&app->frameGraph);
+
+        // With a render thread these are from the frames before
+        rendererFrameResult result;
+        while (rendererPollFinished(&result)) {
+            inputLatencyFramePresented(result.presented, result.presentTime);
+        }
+        frameTimerLimit();
+
+        // In the background, wait out the rest of a slower frame. Any
+        // message ends the wait, so getting focus back takes effect at once.
+        if ((platformGetWindowState() & PLATFORM_WINDOW_UNFOCUSED) && backgroundFps > 0) {
+            u64 periodNs = (u64)(1000000000.0 / backgroundFps);
+            u64 spentNs = platformGetAbsoluteTimeNs() - frameStart;
+            if (spentNs < periodNs) {
+                platformWaitMessages(periodNs - spentNs);
+            }
+        }
     };
 
     FINFO("Shutting Down Engine...");
+    frameTimerLogSummary();
+    FINFO("Simulated %llu ticks, dropped %llu to keep up.", fixedTimestepTicks(),
+          fixedTimestepDroppedTicks());
+    taskGraphLogSummary(&app->frameGraph);
+    inputLatencyLogSummary();
+    inputRecordStop();
 
+    // Jobs may still touch anything below, so the workers go first
+    jobSystemShutdown();
+    taskGraphDestroy(&app->frameGraph);
+    // The render thread may still be drawing with the shaders
+    rendererStopThread();
     shaderSystemShutdown();
     rendererShutdown();
     resourceManagerShutdown(&app->resourceManagerState);
     platformShutdown();
     inputShutdown(&app->inputState);
     eventShutdown();
+    loggerShutdown();
     memoryShutdown();
     return 0;
 }
@@ -9,7 +9,19 @@
 
 b8 fsExists(const char* path){
     struct stat x;
-    return stat(path,&x);
+    return stat(path,&x) == 0;
+}
+
+b8 fsRename(const char* from, const char* to){
+#if FSN_PLATFORM_WINDOWS
+    // rename doesn't replace existing files on windows
+    remove(to);
+#endif
+    return rename(from, to) == 0;
+}
+
+b8 fsRemove(const char* path){
+    return remove(path) == 0;
 }
 
 b8 fsOpen(const char* path, fileModes mode, b8 binary, fileHandle* outHandle){
@@ -132,3 +144,18 @@ b8 fsWrite(fileHandle* fh, u64 dataSize, const void* data, u64* outBytesWritten)
     return false;
 }
 
+b8 fsWriteBuffered(fileHandle* fh, u64 dataSize, const void* data, u64* outBytesWritten){
+    if (fh->handle){
+        *outBytesWritten = fwrite(data,1,dataSize,(FILE*)fh->handle);
+        return *outBytesWritten == dataSize;
+    }
+    return false;
+}
+
+b8 fsFlush(fileHandle* fh){
+    if (fh->handle){
+        return fflush((FILE*)fh->handle) == 0;
+    }
+    return false;
+}
+
@@ -21,6 +21,21 @@ typedef enum fileModes {
  */
 CT_API b8 fsExists(const char* path);
 
+/**
+ * Renames/moves a file, replacing `to` if it exists.
+ * @param from The current path of the file.
+ * @param to The new path of the file.
+ * @returns True if successful; otherwise false.
+ */
+CT_API b8 fsRename(const char* from, const char* to);
+
+/**
+ * Deletes the file at path.
+ * @param path The path of the file to be deleted.
+ * @returns True if successful; otherwise false.
+ */
+CT_API b8 fsRemove(const char* path);
+
 /** 
  * Attempt to open file located at path.
  * @param path The path of the file to be opened.
@@ -104,3 +119,21 @@ CT_API b8 fsReadFileChars(fileHandle* handle, char* outChars, u64* outBytesRead)
  * @returns True if successful; otherwise false.
  */
 CT_API b8 fsWrite(fileHandle* handle, u64 dataSize, const void* data, u64* outBytesWritten);
+
+/** 
+ * Same as fsWrite but leaves the data in the stdio buffer instead of flushing
+ * after every call. Use fsFlush once a batch is done.
+ * @param handle A pointer to a fileHandle structure.
+ * @param dataSize The size of the data in bytes.
+ * @param data The data to be written.
+ * @param outBytesWritten A pointer to a number which will be populated with the number of bytes actually written to the file.
+ * @returns True if successful; otherwise false.
+ */
+CT_API b8 fsWriteBuffered(fileHandle* handle, u64 dataSize, const void* data, u64* outBytesWritten);
+
+/** 
+ * Flushes anything buffered for the file out to the OS.
+ * @param handle A pointer to a fileHandle structure.
+ * @returns True if successful; otherwise false.
+ */
+CT_API b8 fsFlush(fileHandle* handle);
@@ -0,0 +1,66 @@
+#include "platformHeadless.h"
+
+#include "core/input.h"
+#include "platform/platform.h"
+
+// Frames between synthetic key and button presses. Each stays down for half
+// of that.
+#define HEADLESS_KEY_PERIOD 30
+#define HEADLESS_BUTTON_PERIOD 40
+// Pixels the synthetic mouse moves per frame
+#define HEADLESS_MOUSE_STEP 8
+
+typedef struct headlessState {
+    u16 width;
+    u16 height;
+    u64 frame;
+    i16 mouseX;
+    i16 mouseY;
+    i16 stepX;
+    i16 stepY;
+} headlessState;
+
+static headlessState state;
+
+void headlessStartup(u16 width, u16 height) {
+    state.width = width ? width : 1;
+    state.height = height ? height : 1;
+    state.frame = 0;
+    state.mouseX = state.width / 2;
+    state.mouseY = state.height / 2;
+    state.stepX = HEADLESS_MOUSE_STEP;
+    state.stepY = HEADLESS_MOUSE_STEP / 2;
+}
+
+// Moves along one axis, bouncing off the window's edges
+static i16 bounce(i16 pos, i16* step, u16 size) {
+    i32 next = pos + *step;
+    if (next < 0 || next >= size) {
+        *step = -*step;
+        next = pos + *step;
+    }
+    if (next < 0 || next >= size) {
+        return pos;
+    }
+    return (i16)next;
+}
+
+b8 headlessPumpMessages() {
+    f64 now = platformGetAbsoluteTime();
+    u64 frame = state.frame++;
+
+    state.mouseX = bounce(state.mouseX, &state.stepX, state.width);
+    state.mouseY = bounce(state.mouseY, &state.stepY, state.height);
+    inputProcessMouseMove(state.mouseX, state.mouseY, now);
+
+    if (frame % (HEADLESS_KEY_PERIOD / 2) == 0) {
+        inputProcessKey(KEY_SPACE, frame % HEADLESS_KEY_PERIOD == 0, now);
+    }
+    if (frame % (HEADLESS_BUTTON_PERIOD / 2) == 0) {
+        inputProcessButton(BUTTON_LEFT, frame % HEADLESS_BUTTON_PERIOD == 0, now);
+    }
+    if (frame % HEADLESS_KEY_PERIOD == 0) {
+        inputProcessMouseWheel(frame % (HEADLESS_KEY_PERIOD * 2) ? -1 : 1, now);
+    }
+    return true;
+}
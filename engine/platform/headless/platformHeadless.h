@@ -0,0 +1,26 @@
+#pragma once
+
+#include "defines.h"
+
+/**
+ *  Headless platform backend, shared by every platform layer. Picked with
+ * platformStartup's headless flag: no window is opened and nothing is read
+ * from the OS. Instead each platformPumpMessages feeds the input system a
+ * fixed, repeating pattern of synthetic input so the input and event paths
+ * carry load like they would with a user in front of the window. The
+ * renderer draws offscreen (see platformIsHeadless).
+ *
+ *  Input replays still work, live (here synthetic) input is dropped while
+ * one runs like it is for a real window.
+ */
+
+/**
+ * @brief Starts the synthetic input source for a window of width x height.
+ */
+void headlessStartup(u16 width, u16 height);
+
+/**
+ * @brief Feeds this frame's synthetic input.
+ * @returns true, a headless run only ends when the application quits
+ */
+b8 headlessPumpMessages();
@@ -1,6 +1,8 @@
 /**
  * I stole this from somewhere. Can't find it again
  */
+// pthread_setaffinity_np/pthread_setname_np, before anything pulls in libc
+#define _GNU_SOURCE
 #include "platform/platform.h"
 #include "renderer/vulkan/vulkanTypes.h"
 
@@ -11,13 +13,25 @@
 #include "core/input.h"
 #include "core/logger.h"
 #include "helpers/dinoarray.h"
+#include "platform/headless/platformHeadless.h"
 #include "renderer/vulkan/vulkanPlatform.h"
 
 #include <X11/XKBlib.h>   // sudo apt-get install libx11-dev
 #include <X11/Xlib-xcb.h> // sudo apt-get install libxkbcommon-x11-dev
 #include <X11/Xlib.h>
 #include <X11/keysym.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
 #include <sys/time.h>
+#include <unistd.h>
 #include <xcb/xcb.h>
 
 #if _POSIX_C_SOURCE >= 199309L
@@ -42,19 +56,53 @@ typedef struct platformState {
     xcb_atom_t wm_protocols;
     xcb_atom_t wm_delete_win;
     VkSurfaceKHR surface;
+    // Last size reported through EVENT_CODE_RESIZED
+    u16 width;
+    u16 height;
+    // Local clock minus the X server's, see serverTimeToLocal
+    f64 serverTimeOffset;
+    b8 serverTimeOffsetSet;
+    // platformWindowFlags
+    u32 windowState;
+    // Taken off the queue by platformWaitMessages, handled by the next pump
+    xcb_generic_event_t* waitingEvent;
+    // No X connection at all, see platformHeadless.h
+    b8 headless;
 } platformState;
 
 static platformState* systemPtr;
 
+// X event timestamps are the server's millisecond clock. They're moved onto
+// platformGetAbsoluteTime's clock through the smallest difference seen so
+// far, the closest thing to an event that got here instantly.
+static f64 serverTimeToLocal(xcb_timestamp_t time) {
+    f64 serverTime = time / 1000.0;
+    f64 offset = platformGetAbsoluteTime() - serverTime;
+    if (!systemPtr->serverTimeOffsetSet || offset < systemPtr->serverTimeOffset) {
+        systemPtr->serverTimeOffset = offset;
+        systemPtr->serverTimeOffsetSet = true;
+    }
+    return serverTime + systemPtr->serverTimeOffset;
+}
+
 keys translateKeycodeWinToXCB(u32 x_keycode);
 
 b8 platformStartup(u64* memoryRequirement, void* state, const char* appName,
-                   i32 x, i32 y, i32 width, i32 height) {
+                   i32 x, i32 y, i32 width, i32 height, b8 headless) {
     *memoryRequirement = sizeof(platformState);
     if (state == 0) {
         return true;
     }
     systemPtr = state;
+    systemPtr->headless = headless;
+    systemPtr->width = width;
+    systemPtr->height = height;
+
+    if (headless) {
+        headlessStartup(width, height);
+        FINFO("Platform inited headless");
+        return true;
+    }
 
     // Connect to X
     systemPtr->display = XOpenDisplay(NULL);
@@ -97,7 +145,9 @@ b8 platformStartup(u64* memoryRequirement, void* state, const char* appName,
                     XCB_EVENT_MASK_BUTTON_RELEASE | XCB_EVENT_MASK_KEY_PRESS |
                     XCB_EVENT_MASK_KEY_RELEASE | XCB_EVENT_MASK_EXPOSURE |
                     XCB_EVENT_MASK_POINTER_MOTION |
-                    XCB_EVENT_MASK_STRUCTURE_NOTIFY;
+                    XCB_EVENT_MASK_STRUCTURE_NOTIFY |
+                    XCB_EVENT_MASK_VISIBILITY_CHANGE |
+                    XCB_EVENT_MASK_FOCUS_CHANGE;
 
     // Values to be sent over XCB (bg color, events)
     u32 valList[] = {systemPtr->screen->black_pixel, eventVals};
@@ -154,25 +204,74 @@ b8 platformStartup(u64* memoryRequirement, void* state, const char* appName,
     return true;
 }
 
+b8 platformIsHeadless() {
+    return systemPtr && systemPtr->headless;
+}
+
 void platformShutdown() {
+    if (systemPtr->headless) {
+        return;
+    }
     // Turn key repeats back on since this is global for the OS... just... wow.
     // XAutoRepeatOn(systemPtr->display);
 
+    free(systemPtr->waitingEvent);
+    systemPtr->waitingEvent = 0;
     xcb_destroy_window(systemPtr->connection, systemPtr->window);
 }
 
+static void setWindowFlag(u32 flag, b8 set) {
+    u32 state = set ? systemPtr->windowState | flag : systemPtr->windowState & ~flag;
+    if (state == systemPtr->windowState) {
+        return;
+    }
+    systemPtr->windowState = state;
+    eventContext ec;
+    ec.data.u32[0] = state;
+    eventPost(EVENT_CODE_WINDOW_STATE, 0, ec);
+}
+
+u32 platformGetWindowState() {
+    return systemPtr->headless ? 0 : systemPtr->windowState;
+}
+
+b8 platformWaitMessages(u64 timeoutNs) {
+    if (systemPtr->headless || systemPtr->waitingEvent) {
+        return true;
+    }
+    xcb_flush(systemPtr->connection);
+    // Events xcb already read off the socket won't wake poll up
+    systemPtr->waitingEvent = xcb_poll_for_queued_event(systemPtr->connection);
+    if (systemPtr->waitingEvent) {
+        return true;
+    }
+
+    // Same as xcb_wait_for_event, but it can time out
+    struct pollfd pfd;
+    pfd.fd = xcb_get_file_descriptor(systemPtr->connection);
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    i32 timeoutMs = -1;
+    if (timeoutNs != PLATFORM_WAIT_INFINITE) {
+        u64 ms = (timeoutNs + 999999) / 1000000;
+        timeoutMs = ms > 0x7FFFFFFF ? 0x7FFFFFFF : (i32)ms;
+    }
+    return poll(&pfd, 1, timeoutMs) > 0;
+}
+
 b8 platformPumpMessages() {
-    xcb_generic_event_t* event;
+    if (systemPtr->headless) {
+        return headlessPumpMessages();
+    }
     xcb_client_message_event_t* cm;
 
     b8 quitFlagged = false;
 
-    // Poll for events until null is returned.
-    while (event != 0) {
-        event = xcb_poll_for_event(systemPtr->connection);
-        if (event == 0) {
-            break;
-        }
+    // Whatever platformWaitMessages took off the queue goes first, then poll
+    // for events until null is returned.
+    xcb_generic_event_t* event = systemPtr->waitingEvent;
+    systemPtr->waitingEvent = 0;
+    while (event || (event = xcb_poll_for_event(systemPtr->connection))) {
 
         // Input events
         switch (event->response_type & ~0x80) {
@@ -191,7 +290,7 @@ b8 platformPumpMessages() {
                 keys key = translateKeycodeWinToXCB(key_sym);
 
                 // Pass to the input subsystem for processing.
-                inputProcessKey(key, pressed);
+                inputProcessKey(key, pressed, serverTimeToLocal(kb_event->time));
             } break;
             case XCB_BUTTON_PRESS:
             case XCB_BUTTON_RELEASE: {
@@ -213,7 +312,8 @@ b8 platformPumpMessages() {
 
                 // Pass over to the input subsystem.
                 if (mouse_button != BUTTON_MAX_BUTTONS) {
-                    inputProcessButton(mouse_button, pressed);
+                    inputProcessButton(mouse_button, pressed,
+                                       serverTimeToLocal(mouse_event->time));
                 }
             }
             case XCB_MOTION_NOTIFY: {
@@ -222,7 +322,8 @@ b8 platformPumpMessages() {
                     (xcb_motion_notify_event_t*)event;
 
                 // Pass over to the input subsystem.
-                inputProcessMouseMove(move_event->event_x, move_event->event_y);
+                inputProcessMouseMove(move_event->event_x, move_event->event_y,
+                                      serverTimeToLocal(move_event->time));
                 break;
             }
 
@@ -234,14 +335,49 @@ b8 platformPumpMessages() {
                 // The app layer can decide what to do with it.
                 xcb_configure_notify_event_t* configure_event =
                     (xcb_configure_notify_event_t*)event;
+                // Plain moves keep the size, don't bother anyone with those.
+                if (configure_event->width == systemPtr->width &&
+                    configure_event->height == systemPtr->height) {
+                    break;
+                }
+                systemPtr->width = configure_event->width;
+                systemPtr->height = configure_event->height;
+
                 // Fire an event. the app layer should pick this up, but not
                 // handle it
                 //  as it shouldnt be visible to other parts of the app
                 eventContext ec;
                 ec.data.u16[0] = configure_event->width;
                 ec.data.u16[1] = configure_event->height;
-                eventFire(EVENT_CODE_RESIZED, 0, ec);
-            }
+                eventPost(EVENT_CODE_RESIZED, 0, ec);
+            } break;
+
+            // Minimizing unmaps the window
+            case XCB_MAP_NOTIFY:
+            case XCB_UNMAP_NOTIFY:
+                setWindowFlag(PLATFORM_WINDOW_MINIMIZED,
+                              (event->response_type & ~0x80) == XCB_UNMAP_NOTIFY);
+                break;
+
+            case XCB_VISIBILITY_NOTIFY: {
+                xcb_visibility_notify_event_t* visibility =
+                    (xcb_visibility_notify_event_t*)event;
+                setWindowFlag(PLATFORM_WINDOW_OCCLUDED,
+                              visibility->state == XCB_VISIBILITY_FULLY_OBSCURED);
+            } break;
+
+            case XCB_FOCUS_IN:
+            case XCB_FOCUS_OUT: {
+                xcb_focus_in_event_t* focus = (xcb_focus_in_event_t*)event;
+                // Keyboard grabs (e.g. the WM's alt-tab) send focus events
+                // too, the window keeps its focus through them
+                if (focus->mode == XCB_NOTIFY_MODE_GRAB ||
+                    focus->mode == XCB_NOTIFY_MODE_UNGRAB) {
+                    break;
+                }
+                setWindowFlag(PLATFORM_WINDOW_UNFOCUSED,
+                              (event->response_type & ~0x80) == XCB_FOCUS_OUT);
+            } break;
 
             case XCB_CLIENT_MESSAGE: {
                 cm = (xcb_client_message_event_t*)event;
@@ -254,7 +390,7 @@ b8 platformPumpMessages() {
                     quitFlagged = true;
                     eventContext ec;
                     ec.data.u8[0] = true;
-                    eventFire(EVENT_CODE_APPLICATION_QUIT, 0, ec);
+                    eventPost(EVENT_CODE_APPLICATION_QUIT, 0, ec);
                 }
             } break;
             default:
@@ -263,6 +399,7 @@ b8 platformPumpMessages() {
         }
 
         free(event);
+        event = 0;
     }
     return !quitFlagged;
 }
@@ -300,6 +437,12 @@ f64 platformGetAbsoluteTime() {
     return now.tv_sec + now.tv_nsec * 0.000000001;
 }
 
+u64 platformGetAbsoluteTimeNs() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (u64)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
 void platformSleep(u64 ms) {
 #if _POSIX_C_SOURCE >= 199309L
     struct timespec ts;
@@ -314,12 +457,278 @@ void platformSleep(u64 ms) {
 #endif
 }
 
+void platformSleepNs(u64 ns) {
+#if _POSIX_C_SOURCE >= 199309L
+    struct timespec ts;
+    ts.tv_sec = ns / 1000000000ull;
+    ts.tv_nsec = ns % 1000000000ull;
+    // Signals cut it short, carry on with what's left. Any other error
+    // won't go away by retrying.
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+#else
+    usleep((ns + 999) / 1000);
+#endif
+}
+
+typedef struct threadStart {
+    pfnThreadStart fn;
+    void* params;
+} threadStart;
+
+// pthreads wants void* (*)(void*), so bounce through this
+static void* threadTrampoline(void* arg) {
+    threadStart start = *(threadStart*)arg;
+    platformFree(arg, false);
+    return (void*)(u64)start.fn(start.params);
+}
+
+b8 platformThreadCreate(pfnThreadStart startFn, void* params,
+                        platformThread* outThread) {
+    if (!startFn || !outThread) {
+        return false;
+    }
+    threadStart* start = platformAllocate(sizeof(threadStart), false);
+    start->fn = startFn;
+    start->params = params;
+
+    pthread_t handle;
+    if (pthread_create(&handle, 0, threadTrampoline, start) != 0) {
+        FERROR("platformThreadCreate failed to create a thread.");
+        platformFree(start, false);
+        return false;
+    }
+    outThread->internalData = (void*)handle;
+    outThread->id = (u64)handle;
+    return true;
+}
+
+void platformThreadJoin(platformThread* thread) {
+    if (thread && thread->internalData) {
+        pthread_join((pthread_t)thread->internalData, 0);
+        thread->internalData = 0;
+    }
+}
+
+void platformThreadSetName(const char* name) {
+    // The kernel takes 15 characters and the terminator
+    char shortName[16];
+    strncpy(shortName, name, sizeof(shortName) - 1);
+    shortName[sizeof(shortName) - 1] = 0;
+    pthread_setname_np(pthread_self(), shortName);
+}
+
+b8 platformThreadSetAffinity(platformThread* thread, u64 cpuMask) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (u32 i = 0; i < 64; i++) {
+        if (cpuMask & (1ull << i)) {
+            CPU_SET(i, &set);
+        }
+    }
+    pthread_t handle = thread ? (pthread_t)thread->internalData : pthread_self();
+    return pthread_setaffinity_np(handle, sizeof(set), &set) == 0;
+}
+
+u32 platformGetProcessorCount() {
+    // Respects taskset/cgroup CPU restrictions, unlike _SC_NPROCESSORS_ONLN
+    cpu_set_t set;
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        i32 count = CPU_COUNT(&set);
+        if (count > 0) {
+            return count;
+        }
+    }
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    return online > 0 ? (u32)online : 1;
+}
+
+b8 platformMutexCreate(platformMutex* outMutex) {
+    pthread_mutex_t* mutex = platformAllocate(sizeof(pthread_mutex_t), false);
+    if (pthread_mutex_init(mutex, 0) != 0) {
+        FERROR("platformMutexCreate failed to create a mutex.");
+        platformFree(mutex, false);
+        return false;
+    }
+    outMutex->internalData = mutex;
+    return true;
+}
+
+void platformMutexDestroy(platformMutex* mutex) {
+    if (mutex && mutex->internalData) {
+        pthread_mutex_destroy(mutex->internalData);
+        platformFree(mutex->internalData, false);
+        mutex->internalData = 0;
+    }
+}
+
+void platformMutexLock(platformMutex* mutex) {
+    pthread_mutex_lock(mutex->internalData);
+}
+
+void platformMutexUnlock(platformMutex* mutex) {
+    pthread_mutex_unlock(mutex->internalData);
+}
+
+// Tries to take the count this many times before going to sleep, a signal
+// that's about to come is cheaper to wait out than a futex round trip.
+#define SEMAPHORE_SPIN_COUNT 100
+
+typedef struct futexSemaphore {
+    // The futex word
+    _Atomic i32 count;
+    // Threads sleeping (or about to) on count, so signal can skip the
+    // syscall when there's nobody to wake.
+    _Atomic i32 waiters;
+} futexSemaphore;
+
+static b8 semaphoreTryTake(futexSemaphore* sem) {
+    i32 count = atomic_load_explicit(&sem->count, memory_order_relaxed);
+    while (count > 0) {
+        if (atomic_compare_exchange_weak_explicit(&sem->count, &count, count - 1,
+                                                  memory_order_acquire,
+                                                  memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+b8 platformSemaphoreCreate(u32 initialCount, platformSemaphore* outSemaphore) {
+    futexSemaphore* sem = platformAllocate(sizeof(futexSemaphore), false);
+    atomic_init(&sem->count, (i32)initialCount);
+    atomic_init(&sem->waiters, 0);
+    outSemaphore->internalData = sem;
+    return true;
+}
+
+void platformSemaphoreDestroy(platformSemaphore* semaphore) {
+    if (semaphore && semaphore->internalData) {
+        platformFree(semaphore->internalData, false);
+        semaphore->internalData = 0;
+    }
+}
+
+void platformSemaphoreSignal(platformSemaphore* semaphore, u32 count) {
+    futexSemaphore* sem = semaphore->internalData;
+    atomic_fetch_add_explicit(&sem->count, (i32)count, memory_order_seq_cst);
+    // seq_cst on both sides: either the waiter sees the new count before it
+    // sleeps, or this sees the waiter.
+    if (atomic_load_explicit(&sem->waiters, memory_order_seq_cst) > 0) {
+        syscall(SYS_futex, &sem->count, FUTEX_WAKE_PRIVATE, count, 0, 0, 0);
+    }
+}
+
+b8 platformSemaphoreWait(platformSemaphore* semaphore, u64 timeoutNs) {
+    futexSemaphore* sem = semaphore->internalData;
+    for (u32 i = 0; i < SEMAPHORE_SPIN_COUNT; i++) {
+        if (semaphoreTryTake(sem)) {
+            return true;
+        }
+        if (!timeoutNs) {
+            return false;
+        }
+        FSN_CPU_RELAX();
+    }
+
+    u64 deadline = timeoutNs == PLATFORM_WAIT_INFINITE
+                       ? 0
+                       : platformGetAbsoluteTimeNs() + timeoutNs;
+    for (;;) {
+        atomic_fetch_add_explicit(&sem->waiters, 1, memory_order_seq_cst);
+        if (semaphoreTryTake(sem)) {
+            atomic_fetch_sub_explicit(&sem->waiters, 1, memory_order_relaxed);
+            return true;
+        }
+
+        struct timespec ts;
+        struct timespec* timeout = 0;
+        if (deadline) {
+            u64 now = platformGetAbsoluteTimeNs();
+            if (now >= deadline) {
+                atomic_fetch_sub_explicit(&sem->waiters, 1, memory_order_relaxed);
+                return false;
+            }
+            ts.tv_sec = (deadline - now) / 1000000000ull;
+            ts.tv_nsec = (deadline - now) % 1000000000ull;
+            timeout = &ts;
+        }
+        // Only sleeps if count is still 0, so a signal in between isn't lost
+        syscall(SYS_futex, &sem->count, FUTEX_WAIT_PRIVATE, 0, timeout, 0, 0);
+        atomic_fetch_sub_explicit(&sem->waiters, 1, memory_order_relaxed);
+
+        if (semaphoreTryTake(sem)) {
+            return true;
+        }
+    }
+}
+
+b8 platformFileMap(const char* path, u64 size, platformMappedFile* outFile) {
+    platformZeroMemory(outFile, sizeof(platformMappedFile));
+    i32 fd = size ? open(path, O_RDWR | O_CREAT | O_TRUNC, 0644)
+                  : open(path, O_RDWR);
+    if (fd < 0) {
+        return false;
+    }
+
+    if (size) {
+        if (ftruncate(fd, size) != 0) {
+            close(fd);
+            return false;
+        }
+    } else {
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            return false;
+        }
+        size = st.st_size;
+    }
+
+    if (size) {
+        void* data =
+            mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        outFile->data = data;
+    }
+    outFile->size = size;
+    outFile->handle = fd;
+    return true;
+}
+
+void platformFileUnmap(platformMappedFile* file, u64 finalSize) {
+    if (file->data) {
+        munmap(file->data, file->size);
+    }
+    // Can't log a failure here, the logger's file sink calls this
+    i32 result = ftruncate(file->handle, finalSize);
+    (void)result;
+    close(file->handle);
+    platformZeroMemory(file, sizeof(platformMappedFile));
+}
+
+void platformFileMapFlush(platformMappedFile* file) {
+    if (file->data) {
+        msync(file->data, file->size, MS_ASYNC);
+    }
+}
+
 void platformGetRequiredExts(const char*** array) {
+    if (systemPtr->headless) {
+        return;
+    }
     dinoPush(*array, &"VK_KHR_xcb_surface");
 }
 
 // Surface creation for Vulkan
 b8 platformCreateVulkanSurface(VulkanInfo* header) {
+    if (systemPtr->headless) {
+        FERROR("There's no window to create a surface for when headless.");
+        return false;
+    }
     VkXcbSurfaceCreateInfoKHR createInfo = {
         VK_STRUCTURE_TYPE_XCB_SURFACE_CREATE_INFO_KHR};
     createInfo.connection = systemPtr->connection;
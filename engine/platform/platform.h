@@ -2,13 +2,45 @@
 
 #include "defines.h"
 
+/**
+ * @brief Opens the window, or with headless set starts the headless backend
+ * instead (see platform/headless/platformHeadless.h).
+ */
 b8 platformStartup(u64* memoryRequirement, void* state, const char* appName,
-                   i32 x, i32 y, i32 width, i32 height);
+                   i32 x, i32 y, i32 width, i32 height, b8 headless);
+
+/**
+ * @brief True if started headless. There's no window or surface then and the
+ * renderer draws offscreen.
+ */
+b8 platformIsHeadless();
 
 void platformShutdown();
 
 b8 platformPumpMessages();
 
+typedef enum platformWindowFlags {
+    PLATFORM_WINDOW_MINIMIZED = 1 << 0,
+    // Entirely covered by other windows. Only X reports this.
+    PLATFORM_WINDOW_OCCLUDED = 1 << 1,
+    PLATFORM_WINDOW_UNFOCUSED = 1 << 2
+} platformWindowFlags;
+
+/**
+ * @brief The window's platformWindowFlags as of the last
+ * platformPumpMessages. Changes are posted as EVENT_CODE_WINDOW_STATE.
+ * Always 0 headless.
+ */
+u32 platformGetWindowState();
+
+/**
+ * @brief Sleeps until the window system has something for
+ * platformPumpMessages, or timeoutNs runs out. Returns right away headless.
+ * @param timeoutNs PLATFORM_WAIT_INFINITE to wait for as long as it takes
+ * @returns true if there are messages waiting
+ */
+b8 platformWaitMessages(u64 timeoutNs);
+
 void* platformAllocate(u64 size, b8 aligned);
 void platformFree(void* block, b8 aligned);
 void* platformZeroMemory(void* block, u64 size);
@@ -20,4 +52,128 @@ void platformConsoleWriteError(const char* msg, u8 color);
 
 f64 platformGetAbsoluteTime();
 
+/**
+ * @brief Monotonic clock in nanoseconds, same epoch as
+ * platformGetAbsoluteTime. Safe to call before platformStartup.
+ */
+u64 platformGetAbsoluteTimeNs();
+
 void platformSleep(u64 ms);
+
+/**
+ * @brief Sleeps for at least ns nanoseconds. How much longer it takes is up
+ * to the OS scheduler (tens of microseconds on Linux, up to a timer tick on
+ * Windows), spin on platformGetAbsoluteTimeNs where that matters.
+ */
+void platformSleepNs(u64 ns);
+
+// Entry point of a thread. The return value is the thread's exit code.
+typedef u32 (*pfnThreadStart)(void* params);
+
+typedef struct platformThread {
+    // pthread_t/HANDLE
+    void* internalData;
+    u64 id;
+} platformThread;
+
+/**
+ * @brief Starts a new thread running startFn(params).
+ * @returns true if successful, false if failed
+ */
+b8 platformThreadCreate(pfnThreadStart startFn, void* params,
+                        platformThread* outThread);
+
+/**
+ * @brief Blocks until thread has returned and releases it.
+ */
+void platformThreadJoin(platformThread* thread);
+
+/**
+ * @brief Names the calling thread for debuggers and profilers. Linux keeps
+ * the first 15 characters.
+ */
+void platformThreadSetName(const char* name);
+
+/**
+ * @brief Restricts a thread to the CPUs set in cpuMask (bit n = CPU n, so
+ * only the first 64 CPUs can be picked).
+ * @param thread The thread, 0 for the calling one
+ * @returns true if successful, false if failed
+ */
+b8 platformThreadSetAffinity(platformThread* thread, u64 cpuMask);
+
+/**
+ * @brief Logical CPUs available to the process, at least 1.
+ */
+u32 platformGetProcessorCount();
+
+typedef struct platformMutex {
+    // pthread_mutex_t/SRWLOCK
+    void* internalData;
+} platformMutex;
+
+/**
+ * @returns true if successful, false if failed
+ */
+b8 platformMutexCreate(platformMutex* outMutex);
+void platformMutexDestroy(platformMutex* mutex);
+void platformMutexLock(platformMutex* mutex);
+void platformMutexUnlock(platformMutex* mutex);
+
+// Timeout for platformSemaphoreWait that never runs out
+#define PLATFORM_WAIT_INFINITE 0xFFFFFFFFFFFFFFFFull
+
+typedef struct platformSemaphore {
+    // Futex word and waiter count on Linux, semaphore HANDLE on Windows
+    void* internalData;
+} platformSemaphore;
+
+/**
+ * @brief Counting semaphore. Waits and signals that don't have to block or
+ * wake anyone stay out of the kernel.
+ * @returns true if successful, false if failed
+ */
+b8 platformSemaphoreCreate(u32 initialCount, platformSemaphore* outSemaphore);
+void platformSemaphoreDestroy(platformSemaphore* semaphore);
+
+/**
+ * @brief Adds count, waking up to count waiting threads.
+ */
+void platformSemaphoreSignal(platformSemaphore* semaphore, u32 count);
+
+/**
+ * @brief Takes one from the count, waiting for a signal while it's 0.
+ * @param timeoutNs How long to wait at most, 0 to only try,
+ * PLATFORM_WAIT_INFINITE to wait for as long as it takes
+ * @returns true if one was taken, false if it timed out
+ */
+b8 platformSemaphoreWait(platformSemaphore* semaphore, u64 timeoutNs);
+
+typedef struct platformMappedFile {
+    void* data;
+    u64 size;
+    // fd or file/mapping HANDLEs
+    u64 handle;
+    u64 mapping;
+} platformMappedFile;
+
+/**
+ * @brief Maps a file into memory for reading and writing. Writes land in the
+ * file even if the process dies afterwards.
+ * @param path Path to the file
+ * @param size If above 0 the file is created (or emptied) and sized to this.
+ * If 0 an existing file is mapped at its current size.
+ * @param outFile The mapping
+ * @returns true if successful, false if failed
+ */
+b8 platformFileMap(const char* path, u64 size, platformMappedFile* outFile);
+
+/**
+ * @brief Unmaps the file and cuts it down to finalSize bytes.
+ */
+void platformFileUnmap(platformMappedFile* file, u64 finalSize);
+
+/**
+ * @brief Starts writing the dirty pages back to disk without waiting.
+ */
+void platformFileMapFlush(platformMappedFile* file);
@@ -6,6 +6,7 @@
 #include "core/logger.h"
 #include "core/input.h"
 #include "helpers/dinoarray.h"
+#include "platform/headless/platformHeadless.h"
 #include "renderer/vulkan/vulkanPlatform.h"
 #include "core/event.h"
 
@@ -22,12 +23,40 @@ typedef struct platformState {
     HINSTANCE hInstance; //A handle to the instance that contains the window procedure for the class.
     HWND hwnd;
     VkSurfaceKHR surface;
-    f64 clockFreq;
-    LARGE_INTEGER startTime;
+    // Local clock minus GetMessageTime's, see messageTime
+    f64 messageTimeOffset;
+    b8 messageTimeOffsetSet;
+    // platformWindowFlags
+    u32 windowState;
+    // No window at all, see platformHeadless.h
+    b8 headless;
 } platformState;
 
 static platformState* systemPtr;
 
+// Kept out of platformState, the clock is read before platformStartup (the
+// logger stamps its first messages with it)
+static f64 clockFreq;
+static LARGE_INTEGER clockFreqRaw;
+
+static void clockSetup() {
+    QueryPerformanceFrequency(&clockFreqRaw);
+    clockFreq = 1.0 / (f64)clockFreqRaw.QuadPart;
+}
+
+// GetMessageTime is a millisecond tick count. It's moved onto
+// platformGetAbsoluteTime's clock through the smallest difference seen so
+// far, the closest thing to a message that got here instantly.
+static f64 messageTime() {
+    f64 msgTime = (u32)GetMessageTime() / 1000.0;
+    f64 offset = platformGetAbsoluteTime() - msgTime;
+    if (!systemPtr->messageTimeOffsetSet || offset < systemPtr->messageTimeOffset) {
+        systemPtr->messageTimeOffset = offset;
+        systemPtr->messageTimeOffsetSet = true;
+    }
+    return msgTime + systemPtr->messageTimeOffset;
+}
+
 LRESULT CALLBACK win32_process_message(HWND hwnd, u32 msg, WPARAM w_param, LPARAM l_param);
 
 b8 platformStartup(
@@ -37,12 +66,24 @@ b8 platformStartup(
     i32 x,
     i32 y,
     i32 width,
-    i32 height) {
+    i32 height,
+    b8 headless) {
     *memoryRequirement = sizeof(platformState);
     if (state == 0){
         return true;
     }
     systemPtr = state;
+    systemPtr->headless = headless;
+    if (!clockFreq) {
+        clockSetup();
+    }
+
+    if (headless) {
+        headlessStartup(width, height);
+        FINFO("Platform inited headless");
+        return true;
+    }
+
     systemPtr->hInstance = GetModuleHandleA(0);
 
     //Setup and register window class.
@@ -123,15 +164,13 @@ b8 platformStartup(
     //If initially maximized, use SW_SHOWMAXIMIZED : SW_MAXIMIZE
     ShowWindow(systemPtr->hwnd, show_window_command_flags);
 
-    //Clock setup
-    LARGE_INTEGER frequency;
-    QueryPerformanceFrequency(&frequency);
-    systemPtr->clockFreq = 1.0 / (f64)frequency.QuadPart;
-    QueryPerformanceCounter(&systemPtr->startTime);
-
     return true;
 }
 
+b8 platformIsHeadless() {
+    return systemPtr && systemPtr->headless;
+}
+
 void platformShutdown() {
     if (systemPtr && systemPtr->hwnd) {
         DestroyWindow(systemPtr->hwnd);
@@ -140,6 +179,9 @@ void platformShutdown() {
 }
 
 b8 platformPumpMessages() {
+    if (systemPtr->headless) {
+        return headlessPumpMessages();
+    }
     MSG message;
     while (PeekMessageA(&message, NULL, 0, 0, PM_REMOVE)) {
         TranslateMessage(&message);
@@ -149,6 +191,35 @@ b8 platformPumpMessages() {
     return true;
 }
 
+static void setWindowFlag(u32 flag, b8 set) {
+    u32 state = set ? systemPtr->windowState | flag : systemPtr->windowState & ~flag;
+    if (state == systemPtr->windowState) {
+        return;
+    }
+    systemPtr->windowState = state;
+    eventContext ec;
+    ec.data.u32[0] = state;
+    eventPost(EVENT_CODE_WINDOW_STATE, 0, ec);
+}
+
+u32 platformGetWindowState() {
+    return systemPtr->headless ? 0 : systemPtr->windowState;
+}
+
+b8 platformWaitMessages(u64 timeoutNs) {
+    if (systemPtr->headless) {
+        return true;
+    }
+    DWORD timeoutMs = INFINITE;
+    if (timeoutNs != PLATFORM_WAIT_INFINITE) {
+        u64 ms = (timeoutNs + 999999) / 1000000;
+        timeoutMs = ms >= INFINITE ? INFINITE - 1 : (DWORD)ms;
+    }
+    // MWMO_INPUTAVAILABLE so messages already seen by a peek still count
+    return MsgWaitForMultipleObjectsEx(0, NULL, timeoutMs, QS_ALLINPUT, MWMO_INPUTAVAILABLE) ==
+           WAIT_OBJECT_0;
+}
+
 void *platformAllocate(u64 size, b8 aligned) {
     return malloc(size);
 }
@@ -192,27 +263,297 @@ void platformConsoleWriteError(const char *message, u8 color) {
 }
 
 f64 platformGetAbsoluteTime() {
-    if (systemPtr && !systemPtr->clockFreq){
-        LARGE_INTEGER frequency;
-        QueryPerformanceFrequency(&frequency);
-        systemPtr->clockFreq = 1.0 / (f64)frequency.QuadPart;
-        QueryPerformanceCounter(&systemPtr->startTime);
+    if (!clockFreq){
+        clockSetup();
+    }
+    LARGE_INTEGER now_time;
+    QueryPerformanceCounter(&now_time);
+    return (f64)now_time.QuadPart * clockFreq;
+}
+
+u64 platformGetAbsoluteTimeNs() {
+    if (!clockFreq){
+        clockSetup();
     }
     LARGE_INTEGER now_time;
     QueryPerformanceCounter(&now_time);
-    return (f64)now_time.QuadPart * systemPtr->clockFreq;
+    // Split so the multiply can't overflow
+    u64 ticks = now_time.QuadPart;
+    u64 freq = clockFreqRaw.QuadPart;
+    return ticks / freq * 1000000000ull + ticks % freq * 1000000000ull / freq;
 }
 
 void platformSleep(u64 ms) {
     Sleep(ms);
 }
 
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+void platformSleepNs(u64 ns) {
+    // Sleep runs on the ~15.6 ms system tick, so use a high resolution
+    // timer instead. One per thread, made on first use and kept until exit.
+    static FSN_THREAD_LOCAL HANDLE timer;
+    static FSN_THREAD_LOCAL b8 noTimer;
+    if (!timer && !noTimer) {
+        // Only there since Windows 10 1803
+        timer = CreateWaitableTimerExW(0, 0, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION,
+                                       TIMER_ALL_ACCESS);
+        noTimer = !timer;
+    }
+    if (timer) {
+        // Relative due times are negative, in 100 ns units
+        LARGE_INTEGER due;
+        due.QuadPart = -(LONGLONG)(ns / 100);
+        if (SetWaitableTimer(timer, &due, 0, 0, 0, FALSE)) {
+            WaitForSingleObject(timer, INFINITE);
+            return;
+        }
+    }
+    Sleep((DWORD)(ns / 1000000));
+}
+
+typedef struct threadStart {
+    pfnThreadStart fn;
+    void* params;
+} threadStart;
+
+// CreateThread wants DWORD WINAPI (*)(LPVOID), so bounce through this
+static DWORD WINAPI threadTrampoline(LPVOID arg) {
+    threadStart start = *(threadStart*)arg;
+    platformFree(arg, false);
+    return (DWORD)start.fn(start.params);
+}
+
+b8 platformThreadCreate(pfnThreadStart startFn, void* params,
+                        platformThread* outThread) {
+    if (!startFn || !outThread) {
+        return false;
+    }
+    threadStart* start = platformAllocate(sizeof(threadStart), false);
+    start->fn = startFn;
+    start->params = params;
+
+    DWORD id;
+    HANDLE handle = CreateThread(0, 0, threadTrampoline, start, 0, &id);
+    if (!handle) {
+        FERROR("platformThreadCreate failed to create a thread.");
+        platformFree(start, false);
+        return false;
+    }
+    outThread->internalData = handle;
+    outThread->id = id;
+    return true;
+}
+
+void platformThreadJoin(platformThread* thread) {
+    if (thread && thread->internalData) {
+        WaitForSingleObject(thread->internalData, INFINITE);
+        CloseHandle(thread->internalData);
+        thread->internalData = 0;
+    }
+}
+
+typedef HRESULT (WINAPI *pfnSetThreadDescription)(HANDLE thread, PCWSTR description);
+
+void platformThreadSetName(const char* name) {
+    // Only there since Windows 10 1607, so look it up rather than link it
+    static pfnSetThreadDescription setDescription;
+    if (!setDescription) {
+        setDescription = (pfnSetThreadDescription)GetProcAddress(
+            GetModuleHandleA("kernel32.dll"), "SetThreadDescription");
+        if (!setDescription) {
+            return;
+        }
+    }
+    wchar_t wideName[64];
+    if (MultiByteToWideChar(CP_UTF8, 0, name, -1, wideName, 64) == 0) {
+        return;
+    }
+    setDescription(GetCurrentThread(), wideName);
+}
+
+b8 platformThreadSetAffinity(platformThread* thread, u64 cpuMask) {
+    HANDLE handle = thread ? thread->internalData : GetCurrentThread();
+    return SetThreadAffinityMask(handle, (DWORD_PTR)cpuMask) != 0;
+}
+
+u32 platformGetProcessorCount() {
+    DWORD count = GetActiveProcessorCount(ALL_PROCESSOR_GROUPS);
+    return count ? count : 1;
+}
+
+b8 platformMutexCreate(platformMutex* outMutex) {
+    SRWLOCK* lock = platformAllocate(sizeof(SRWLOCK), false);
+    InitializeSRWLock(lock);
+    outMutex->internalData = lock;
+    return true;
+}
+
+void platformMutexDestroy(platformMutex* mutex) {
+    if (mutex && mutex->internalData) {
+        platformFree(mutex->internalData, false);
+        mutex->internalData = 0;
+    }
+}
+
+void platformMutexLock(platformMutex* mutex) {
+    AcquireSRWLockExclusive(mutex->internalData);
+}
+
+void platformMutexUnlock(platformMutex* mutex) {
+    ReleaseSRWLockExclusive(mutex->internalData);
+}
+
+// Tries to take the count this many times before blocking
+#define SEMAPHORE_SPIN_COUNT 100
+
+// The count lives in user space and goes negative by the number of blocked
+// waiters, only they touch the kernel semaphore.
+typedef struct win32Semaphore {
+    volatile LONG count;
+    HANDLE handle;
+} win32Semaphore;
+
+b8 platformSemaphoreCreate(u32 initialCount, platformSemaphore* outSemaphore) {
+    win32Semaphore* sem = platformAllocate(sizeof(win32Semaphore), false);
+    sem->count = (LONG)initialCount;
+    sem->handle = CreateSemaphoreA(0, 0, MAXLONG, 0);
+    if (!sem->handle) {
+        FERROR("platformSemaphoreCreate failed to create a semaphore.");
+        platformFree(sem, false);
+        return false;
+    }
+    outSemaphore->internalData = sem;
+    return true;
+}
+
+void platformSemaphoreDestroy(platformSemaphore* semaphore) {
+    if (semaphore && semaphore->internalData) {
+        win32Semaphore* sem = semaphore->internalData;
+        CloseHandle(sem->handle);
+        platformFree(sem, false);
+        semaphore->internalData = 0;
+    }
+}
+
+void platformSemaphoreSignal(platformSemaphore* semaphore, u32 count) {
+    win32Semaphore* sem = semaphore->internalData;
+    LONG old = InterlockedExchangeAdd(&sem->count, (LONG)count);
+    LONG blocked = old < 0 ? -old : 0;
+    LONG wake = blocked < (LONG)count ? blocked : (LONG)count;
+    if (wake > 0) {
+        ReleaseSemaphore(sem->handle, wake, 0);
+    }
+}
+
+b8 platformSemaphoreWait(platformSemaphore* semaphore, u64 timeoutNs) {
+    win32Semaphore* sem = semaphore->internalData;
+    for (u32 i = 0; i < SEMAPHORE_SPIN_COUNT; i++) {
+        LONG count = sem->count;
+        if (count > 0 && InterlockedCompareExchange(&sem->count, count - 1, count) == count) {
+            return true;
+        }
+        if (!timeoutNs) {
+            return false;
+        }
+        FSN_CPU_RELAX();
+    }
+
+    if (InterlockedDecrement(&sem->count) >= 0) {
+        return true;
+    }
+    DWORD ms = timeoutNs == PLATFORM_WAIT_INFINITE
+                   ? INFINITE
+                   : (DWORD)((timeoutNs + 999999) / 1000000);
+    if (WaitForSingleObject(sem->handle, ms) == WAIT_OBJECT_0) {
+        return true;
+    }
+
+    // Timed out, stop counting as a waiter. If a signal already counted on
+    // us its release is on its way and has to be taken.
+    for (;;) {
+        LONG count = sem->count;
+        if (count < 0) {
+            if (InterlockedCompareExchange(&sem->count, count + 1, count) == count) {
+                return false;
+            }
+        } else {
+            WaitForSingleObject(sem->handle, INFINITE);
+            return true;
+        }
+    }
+}
+
+b8 platformFileMap(const char* path, u64 size, platformMappedFile* outFile) {
+    platformZeroMemory(outFile, sizeof(platformMappedFile));
+    HANDLE file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, 0,
+                              size ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    if (!size) {
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize)) {
+            CloseHandle(file);
+            return false;
+        }
+        size = fileSize.QuadPart;
+    }
+
+    if (size) {
+        HANDLE mapping = CreateFileMappingA(file, 0, PAGE_READWRITE, (DWORD)(size >> 32),
+                                            (DWORD)size, 0);
+        void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size) : 0;
+        if (!data) {
+            if (mapping) {
+                CloseHandle(mapping);
+            }
+            CloseHandle(file);
+            return false;
+        }
+        outFile->data = data;
+        outFile->mapping = (u64)mapping;
+    }
+    outFile->size = size;
+    outFile->handle = (u64)file;
+    return true;
+}
+
+void platformFileUnmap(platformMappedFile* file, u64 finalSize) {
+    if (file->data) {
+        UnmapViewOfFile(file->data);
+        CloseHandle((HANDLE)file->mapping);
+    }
+    LARGE_INTEGER pos;
+    pos.QuadPart = finalSize;
+    SetFilePointerEx((HANDLE)file->handle, pos, 0, FILE_BEGIN);
+    SetEndOfFile((HANDLE)file->handle);
+    CloseHandle((HANDLE)file->handle);
+    platformZeroMemory(file, sizeof(platformMappedFile));
+}
+
+void platformFileMapFlush(platformMappedFile* file) {
+    if (file->data) {
+        FlushViewOfFile(file->data, 0);
+    }
+}
+
 void platformGetRequiredExts(const char*** array){
+    if (systemPtr->headless) {
+        return;
+    }
     dinoPush(*array,&"VK_KHR_win32_surface");
 }
 
 // Surface creation for Vulkan
 b8 platformCreateVulkanSurface(vulkanHeader *header) {
+    if (systemPtr->headless) {
+        FERROR("There's no window to create a surface for when headless.");
+        return false;
+    }
     VkWin32SurfaceCreateInfoKHR createInfo = {VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR};
     createInfo.hinstance = systemPtr->hInstance;
     createInfo.hwnd = systemPtr->hwnd;
@@ -234,7 +575,7 @@ LRESULT CALLBACK win32_process_message(HWND hwnd, u32 msg, WPARAM w_param, LPARA
             return 1;
         case WM_CLOSE:
             eventContext data = {};
-            eventFire(EVENT_CODE_APPLICATION_QUIT,0,data);
+            eventPost(EVENT_CODE_APPLICATION_QUIT,0,data);
             return true;
         case WM_DESTROY:
             PostQuitMessage(0);
@@ -251,8 +592,13 @@ LRESULT CALLBACK win32_process_message(HWND hwnd, u32 msg, WPARAM w_param, LPARA
             eventContext ec;
             ec.data.u16[0] = (u16)width;
             ec.data.u16[1] = (u16)height;
-            eventFire(EVENT_CODE_RESIZED, 0, ec);
+            eventPost(EVENT_CODE_RESIZED, 0, ec);
+            setWindowFlag(PLATFORM_WINDOW_MINIMIZED, w_param == SIZE_MINIMIZED);
         } break;
+        case WM_SETFOCUS:
+        case WM_KILLFOCUS:
+            setWindowFlag(PLATFORM_WINDOW_UNFOCUSED, msg == WM_KILLFOCUS);
+            break;
         case WM_KEYDOWN:
         case WM_SYSKEYDOWN:
         case WM_KEYUP:
@@ -281,21 +627,21 @@ LRESULT CALLBACK win32_process_message(HWND hwnd, u32 msg, WPARAM w_param, LPARA
                 }
             }
 
-            inputProcessKey(key,pressed);
+            inputProcessKey(key,pressed,messageTime());
         } break;
         case WM_MOUSEMOVE: {
             //Mouse move
             i32 xPos = GET_X_LPARAM(l_param);
             i32 yPos = GET_Y_LPARAM(l_param);
 
-            inputProcessMouseMove(xPos,yPos);
+            inputProcessMouseMove(xPos,yPos,messageTime());
         } break;
         case WM_MOUSEWHEEL: {
             i32 z_delta = GET_WHEEL_DELTA_WPARAM(w_param);
             if (z_delta != 0) {
                 // Flatten the input to an OS-independent (-1, 1)
                 z_delta = (z_delta < 0) ? -1 : 1;
-                inputProcessMouseWheel(z_delta);
+                inputProcessMouseWheel(z_delta,messageTime());
             }
         } break;
         case WM_LBUTTONDOWN:
@@ -315,7 +661,7 @@ LRESULT CALLBACK win32_process_message(HWND hwnd, u32 msg, WPARAM w_param, LPARA
                     break;
             }
             if (mouseBtn != BUTTON_MAX_BUTTONS){
-                inputProcessButton(mouseBtn,pressed);
+                inputProcessButton(mouseBtn,pressed,messageTime());
             }
         case WM_LBUTTONUP:
         case WM_MBUTTONUP:
@@ -334,7 +680,7 @@ LRESULT CALLBACK win32_process_message(HWND hwnd, u32 msg, WPARAM w_param, LPARA
                     break;
             }
             if (mouseBtn != BUTTON_MAX_BUTTONS){
-                inputProcessButton(mouseBtn,pressed);
+                inputProcessButton(mouseBtn,pressed,messageTime());
             }
         } break;
     }
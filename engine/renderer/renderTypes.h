@@ -1,6 +1,7 @@
 #pragma once
 
 #include "defines.h"
+#include "math/matrixMath.h"
 
 struct ShaderRS;
 struct Shader;
@@ -10,9 +11,40 @@ typedef enum rendererBackendAPI {
     RENDERER_BACKEND_API_VULKAN
 } rendererBackendAPI;
 
-typedef struct renderInfo {
+typedef struct renderDrawCmd {
+    mat4 model;
+} renderDrawCmd;
+
+// Everything the renderer needs to draw a frame. Filled in by the frame that
+// acquired it and not touched again after rendererSubmitPacket, so it can be
+// drawn on the render thread while the next one is being built. Anything it
+// points to lives in the packet's frame arena (rendererPacketAllocate).
+typedef struct renderPacket {
+    u64 frame;
     f32 deltaTime;
-} renderInfo;
+    // How far the frame is between the last two simulation ticks, 0 at the
+    // older one. Draw lerp(previous, current, alpha).
+    f32 alpha;
+    // Framebuffer size the frame is drawn at, a change resizes the swapchain
+    u16 width;
+    u16 height;
+
+    // Camera
+    mat4 view;
+    mat4 projection;
+
+    renderDrawCmd* draws;
+    u32 drawCount;
+} renderPacket;
+
+// What became of a submitted packet, see rendererPollFinished
+typedef struct rendererFrameResult {
+    u64 frame;
+    // false if the frame was skipped (e.g. swapchain being rebuilt)
+    b8 presented;
+    // When the present was submitted, platformGetAbsoluteTime's clock
+    f64 presentTime;
+} rendererFrameResult;
 
 // The info and PFN signatures that will connect the engine's render abstraction
 // layer to vulkan
@@ -27,7 +59,7 @@ typedef struct rendererBackend {
 
     void (*shutdown)(struct rendererBackend* backend);
 
-    b8 (*draw)(renderInfo* ri);
+    b8 (*draw)(const renderPacket* packet);
     b8 (*beginFrame)(struct rendererBackend* backend, f32 deltaTime);
     b8 (*endFrame)(struct rendererBackend* backend, f32 deltaTime);
     b8 (*beginRenderpass)(struct rendererBackend* backend, u8 renderpassId);
@@ -1,12 +1,42 @@
 #include "renderer.h"
+#include "core/fmemory.h"
+#include "core/linearAllocator.h"
 #include "core/logger.h"
+#include "helpers/ringbuffer.h"
+#include "platform/platform.h"
 #include "renderer/vulkan/vulkan.h"
 #include "renderer/vulkan/vulkanShader.h"
 
+#include <stdatomic.h>
+
+typedef struct packetSlot {
+    renderPacket packet;
+    linearAllocator arena;
+} packetSlot;
+
 typedef struct rendererSystem {
     rendererBackend rb;
     u32 frameBufferWidth;
     u32 frameBufferHeight;
+    // Set by rendererBeginFrame if the backend started a frame
+    b8 frameBegun;
+
+    packetSlot slots[RENDER_PACKET_COUNT];
+    // Next slot rendererAcquirePacket hands out
+    u32 nextSlot;
+    u64 frame;
+    // Slots that aren't being built or drawn
+    platformSemaphore freeSlots;
+    // rendererFrameResults for rendererPollFinished
+    spscRing finished;
+
+    // Render thread, only with rendererSettings.renderThread
+    b8 threaded;
+    _Atomic b8 running;
+    platformThread thread;
+    // Indices of packets waiting for the render thread
+    spscRing submitted;
+    platformSemaphore submittedCount;
 } rendererSystem;
 
 static rendererSystem* systemPtr;
@@ -59,16 +89,49 @@ b8 rendererDestroy(rendererBackend* rb) {
     return true;
 }
 
-b8 rendererInit(u64* memoryRequirement, void* memoryState, const char* appName,
-                u64 appWidth, u64 appHeight) {
-    *memoryRequirement = sizeof(rendererSystem);
+static u32 renderThreadMain(void* params) {
+    platformThreadSetName("fsnRender");
+    for (;;) {
+        platformSemaphoreWait(&systemPtr->submittedCount, PLATFORM_WAIT_INFINITE);
+        u32 idx;
+        // Everything submitted before shutdown is still drawn
+        if (!spscRingPop(&systemPtr->submitted, &idx)) {
+            if (!atomic_load_explicit(&systemPtr->running, memory_order_acquire)) {
+                break;
+            }
+            continue;
+        }
+        rendererDraw(&systemPtr->slots[idx].packet);
+    }
+    return 0;
+}
+
+b8 rendererInit(u64* memoryRequirement, void* memoryState, rendererSettings settings) {
+    u64 stateReq = sizeof(rendererSystem);
+    u64 arenaReq = 0;
+    linearAllocCreate(settings.packetArenaSize, &arenaReq, 0, 0);
+    *memoryRequirement = stateReq + arenaReq * RENDER_PACKET_COUNT;
     if (memoryState == 0) {
         return true;
     }
     systemPtr = memoryState;
 
-    systemPtr->frameBufferWidth = appWidth;
-    systemPtr->frameBufferHeight = appHeight;
+    for (u32 i = 0; i < RENDER_PACKET_COUNT; i++) {
+        void* arenaMemory = (void*)((u64)memoryState + stateReq + arenaReq * i);
+        linearAllocCreate(settings.packetArenaSize, &arenaReq, arenaMemory,
+                          &systemPtr->slots[i].arena);
+    }
+    // Polled dry once per packet, results pile up for at most the packets
+    // in flight plus the one acquired since, so finished can't fill
+    if (!platformSemaphoreCreate(RENDER_PACKET_COUNT, &systemPtr->freeSlots) ||
+        !spscRingCreate(sizeof(rendererFrameResult), RENDER_PACKET_COUNT + 1,
+                        &systemPtr->finished)) {
+        FERROR("Renderer failed to create its packet queues.");
+        return false;
+    }
+
+    systemPtr->frameBufferWidth = settings.width;
+    systemPtr->frameBufferHeight = settings.height;
 
     // Assign the pointer functions to the real functions
     if (!rendererCreate(RENDERER_BACKEND_API_VULKAN, &systemPtr->rb)) {
@@ -77,44 +140,153 @@ b8 rendererInit(u64* memoryRequirement, void* memoryState, const char* appName,
     }
     systemPtr->rb.frameNum = 0;
     // Init the renderer
-    if (!systemPtr->rb.init(&systemPtr->rb, appName, appWidth, appHeight)) {
+    if (!systemPtr->rb.init(&systemPtr->rb, settings.appName, settings.width,
+                            settings.height)) {
         FERROR("Renderer Init Failed");
         return false;
     }
+
+    if (settings.renderThread) {
+        if (!spscRingCreate(sizeof(u32), RENDER_PACKET_COUNT, &systemPtr->submitted) ||
+            !platformSemaphoreCreate(0, &systemPtr->submittedCount)) {
+            FERROR("Renderer failed to create the render thread's queue.");
+            return false;
+        }
+        atomic_store(&systemPtr->running, true);
+        if (!platformThreadCreate(renderThreadMain, 0, &systemPtr->thread)) {
+            FERROR("Renderer failed to start the render thread.");
+            return false;
+        }
+        systemPtr->threaded = true;
+    }
     FDEBUG("Renderer inited.");
     return true;
 }
 
+void rendererStopThread() {
+    if (!systemPtr->threaded) {
+        return;
+    }
+    atomic_store_explicit(&systemPtr->running, false, memory_order_release);
+    platformSemaphoreSignal(&systemPtr->submittedCount, 1);
+    platformThreadJoin(&systemPtr->thread);
+    spscRingDestroy(&systemPtr->submitted);
+    platformSemaphoreDestroy(&systemPtr->submittedCount);
+    systemPtr->threaded = false;
+}
+
 void rendererShutdown() {
+    rendererStopThread();
     systemPtr->rb.shutdown(&systemPtr->rb);
     rendererDestroy(&systemPtr->rb);
+    spscRingDestroy(&systemPtr->finished);
+    platformSemaphoreDestroy(&systemPtr->freeSlots);
 }
 
-b8 rendererDraw(renderInfo* ri){
-    if (systemPtr->rb.beginFrame(&systemPtr->rb, ri->deltaTime)){
-        if (!systemPtr->rb.beginRenderpass(&systemPtr->rb, 0)){
-            FERROR("BeginRenderpass failed")
-            return false;
-        }
+b8 rendererIsThreaded() {
+    return systemPtr->threaded;
+}
 
-        // TODO: Update global state
+renderPacket* rendererAcquirePacket() {
+    // Only waits when the render thread is two frames behind
+    platformSemaphoreWait(&systemPtr->freeSlots, PLATFORM_WAIT_INFINITE);
+    packetSlot* slot = &systemPtr->slots[systemPtr->nextSlot];
+    systemPtr->nextSlot = (systemPtr->nextSlot + 1) % RENDER_PACKET_COUNT;
 
-        systemPtr->rb.draw(ri);
+    linearAllocReset(&slot->arena);
+    fzeroMemory(&slot->packet, sizeof(renderPacket));
+    slot->packet.frame = systemPtr->frame++;
+    return &slot->packet;
+}
 
-        if (!systemPtr->rb.endRenderpass(&systemPtr->rb, 0)){
-            FERROR("EndRenderpass failed");
-            return false;
-        }
+void* rendererPacketAllocate(renderPacket* packet, u64 size) {
+    packetSlot* slot = (packetSlot*)packet;
+    return linearAlloc(&slot->arena, size);
+}
 
-        if (!systemPtr->rb.endFrame(&systemPtr->rb, ri->deltaTime)){
-            FERROR("EndFrame failed");
-            return false;
-        }
-        systemPtr->rb.frameNum++;
+void rendererSubmitPacket(renderPacket* packet) {
+    if (!systemPtr->threaded) {
+        rendererDraw(packet);
+        return;
     }
+    u32 idx = (u32)((packetSlot*)packet - systemPtr->slots);
+    // Can't be full, there are only as many packets as it holds
+    spscRingPush(&systemPtr->submitted, &idx);
+    platformSemaphoreSignal(&systemPtr->submittedCount, 1);
+}
+
+b8 rendererPollFinished(rendererFrameResult* outResult) {
+    return spscRingPop(&systemPtr->finished, outResult);
+}
+
+b8 rendererBeginFrame(const renderPacket* packet){
+    // Resizes go through the packet so they reach the backend on the thread
+    // that draws
+    if (packet->width && packet->height) {
+        systemPtr->rb.onResize(packet->width, packet->height);
+    }
+    systemPtr->frameBegun = systemPtr->rb.beginFrame(&systemPtr->rb, packet->deltaTime);
     return true;
 }
 
+b8 rendererRecord(const renderPacket* packet){
+    if (!systemPtr->frameBegun){
+        return true;
+    }
+    if (!systemPtr->rb.beginRenderpass(&systemPtr->rb, 0)){
+        FERROR("BeginRenderpass failed")
+        systemPtr->frameBegun = false;
+        return false;
+    }
+
+    // TODO: Update global state
+
+    systemPtr->rb.draw(packet);
+
+    if (!systemPtr->rb.endRenderpass(&systemPtr->rb, 0)){
+        FERROR("EndRenderpass failed");
+        systemPtr->frameBegun = false;
+        return false;
+    }
+    return true;
+}
+
+// Hands the packet's slot back and reports how the frame went
+static void finishPacket(const renderPacket* packet, b8 presented) {
+    rendererFrameResult result;
+    result.frame = packet->frame;
+    result.presented = presented;
+    result.presentTime = platformGetAbsoluteTime();
+    // Only full if rendererPollFinished isn't drained every packet. Then
+    // this newest result is the one dropped.
+    if (!spscRingPush(&systemPtr->finished, &result)) {
+        FWARN_LIMITED(1, "Frame results aren't being polled.");
+    }
+    platformSemaphoreSignal(&systemPtr->freeSlots, 1);
+}
+
+b8 rendererEndFrame(const renderPacket* packet){
+    if (!systemPtr->frameBegun){
+        finishPacket(packet, false);
+        return true;
+    }
+    systemPtr->frameBegun = false;
+    if (!systemPtr->rb.endFrame(&systemPtr->rb, packet->deltaTime)){
+        FERROR("EndFrame failed");
+        finishPacket(packet, false);
+        return false;
+    }
+    systemPtr->rb.frameNum++;
+    finishPacket(packet, true);
+    return true;
+}
+
+b8 rendererDraw(const renderPacket* packet){
+    rendererBeginFrame(packet);
+    rendererRecord(packet);
+    return rendererEndFrame(packet);
+}
+
 b8 rendererOnResized(u16 width, u16 height){
     return systemPtr->rb.onResize(width, height);
 }
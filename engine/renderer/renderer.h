@@ -5,10 +5,96 @@
 struct platformState;
 struct ShaderUniform;
 
-b8 rendererInit(u64* memoryRequirement, void* memoryState, const char* appName, u64 appWidth, u64 appHeight);
+// Packets in flight: one being built while the other is drawn
+#define RENDER_PACKET_COUNT 2
+
+typedef struct rendererSettings {
+    const char* appName;
+    u64 width;
+    u64 height;
+    // Draw on a thread of its own, so the next frame is built while this
+    // one waits on the GPU
+    b8 renderThread;
+    // Frame arena of each packet
+    u64 packetArenaSize;
+} rendererSettings;
+
+b8 rendererInit(u64* memoryRequirement, void* memoryState, rendererSettings settings);
+
+/**
+ * @brief Draws whatever was still submitted and joins the render thread.
+ * Call before destroying anything its draws use, e.g. the shader system.
+ * Packets submitted afterwards draw on the calling thread.
+ */
+void rendererStopThread();
+
+/**
+ * @brief Stops the render thread if it's still running, then the backend.
+ */
 void rendererShutdown();
 
-b8 rendererDraw(renderInfo* ri);
+b8 rendererIsThreaded();
+
+/**
+ * @brief Hands out the next packet to build a frame in, its frame arena
+ * emptied. Waits while every packet is still being drawn.
+ */
+renderPacket* rendererAcquirePacket();
+
+/**
+ * @brief Allocates from the packet's frame arena, freed when the packet is
+ * acquired again.
+ * @returns 0 if the arena is full
+ */
+void* rendererPacketAllocate(renderPacket* packet, u64 size);
+
+/**
+ * @brief Queues the packet for the render thread, or draws it right away
+ * without one. The packet can't be touched afterwards.
+ */
+void rendererSubmitPacket(renderPacket* packet);
+
+/**
+ * @brief Takes the result of the oldest drawn packet that hasn't been polled
+ * yet. Call from the thread that acquires packets, until it returns false,
+ * once per acquired packet or results get dropped.
+ * @returns false if there's none
+ */
+b8 rendererPollFinished(rendererFrameResult* outResult);
+
+/**
+ * @brief rendererBeginFrame, rendererRecord and rendererEndFrame in one go.
+ */
+b8 rendererDraw(const renderPacket* packet);
+
+/*
+ * The three phases of rendererDraw, for running them as separate frame
+ * tasks without a render thread. They have to be called in order and never
+ * at the same time, but each can be on a different thread. If
+ * rendererBeginFrame doesn't get a frame (e.g. the swapchain is being
+ * rebuilt) rendererRecord does nothing. rendererEndFrame always has to be
+ * called, it hands the packet back.
+ *
+ * rendererBeginFrame only reads the packet's frame, deltaTime and size, the
+ * rest can still be filled in while it runs.
+ */
+
+/**
+ * @brief Waits for the frame's resources and acquires the next image.
+ */
+b8 rendererBeginFrame(const renderPacket* packet);
+/**
+ * @brief Records the packet's draws.
+ */
+b8 rendererRecord(const renderPacket* packet);
+/**
+ * @brief Submits and presents the frame and hands the packet back.
+ */
+b8 rendererEndFrame(const renderPacket* packet);
+/**
+ * @brief Tells the backend about a new framebuffer size right away. Only
+ * without a render thread, the size in each packet is the safe way.
+ */
 b8 rendererOnResized(u16 width, u16 height);
 
 b8 rendererShaderCreate(const struct ShaderRS* srs, struct Shader* outShader);
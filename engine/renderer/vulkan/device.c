@@ -103,7 +103,8 @@ b8 createVulkanLogicalDevice(VulkanInfo* header) {
     deviceCI.queueCreateInfoCount = idxCnt;
     deviceCI.pQueueCreateInfos = queueCIs;
     deviceCI.pEnabledFeatures = &deviceFeatures;
-    deviceCI.enabledExtensionCount = 1;
+    // Offscreen nothing gets presented, so no swapchain either
+    deviceCI.enabledExtensionCount = header->offscreen ? 0 : 1;
     const char* extension_names = VK_KHR_SWAPCHAIN_EXTENSION_NAME;
     deviceCI.ppEnabledExtensionNames = &extension_names;
 
@@ -138,6 +139,9 @@ b8 createVulkanLogicalDevice(VulkanInfo* header) {
                                  &header->device.graphicsCommandPool));
     FINFO("Graphics command pool created.");
 
+    if (header->offscreen) {
+        return true;
+    }
     vulkanDeviceQuerySwapchainSupport(header->device.physicalDevice,
                                       header->surface,
                                       &header->device.swapchainSupport);
@@ -217,13 +221,20 @@ b8 doesDeviceMeetRequirements(VkPhysicalDevice device, VkSurfaceKHR surface,
 
         // Present queue
         VkBool32 supportsPresent = VK_FALSE;
-        vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface,
-                                             &supportsPresent);
+        if (surface) {
+            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface,
+                                                 &supportsPresent);
+        }
         if (supportsPresent) {
             outQueuesInfo->presentFamilyIdx = i;
         }
     }
 
+    // Without a surface nothing is presented, the graphics queue stands in
+    if (!surface) {
+        outQueuesInfo->presentFamilyIdx = outQueuesInfo->graphicsFamilyIdx;
+    }
+
     return true;
 }
 
@@ -243,12 +254,16 @@ b8 vulkanDeviceGetCreate(VulkanInfo* vi) {
     // TODO: Make some of these configurable options if able
     deviceRequirements requirements = {};
     requirements.graphics = true;
-    requirements.present = true;
+    requirements.present = !vi->offscreen;
     requirements.transfer = true;
     requirements.samplerAnisotropy = true;
-    requirements.discreteGPU = true;
+    // Headless runs are meant for machines without a GPU, where a software
+    // driver like lavapipe is all there is.
+    requirements.discreteGPU = !vi->offscreen;
     requirements.deviceExts = dinoCreate(const char*);
-    dinoPush(requirements.deviceExts, &VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    if (!vi->offscreen) {
+        dinoPush(requirements.deviceExts, &VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    }
 
     for (u32 i = 0; i < deviceCnt; ++i) {
         VkPhysicalDevice device = devices[i];
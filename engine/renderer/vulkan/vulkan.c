@@ -2,7 +2,9 @@
 #include "core/fstring.h"
 #include "core/logger.h"
 #include "helpers/dinoarray.h"
+#include "math/fsnmath.h"
 #include "math/matrixMath.h"
+#include "platform/platform.h"
 #include "renderer/renderTypes.h"
 #include "renderer/vulkan/device.h"
 #include "renderer/vulkan/utils.h"
@@ -27,16 +29,16 @@ debugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
     switch (messageSeverity) {
         default:
         case VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT:
-            FERROR(pCallbackData->pMessage);
+            FERROR("%s", pCallbackData->pMessage);
             break;
         case VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT:
-            FWARN(pCallbackData->pMessage);
+            FWARN("%s", pCallbackData->pMessage);
             break;
         case VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT:
-            FINFO(pCallbackData->pMessage);
+            FINFO("%s", pCallbackData->pMessage);
             break;
         case VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT:
-            FTRACE(pCallbackData->pMessage);
+            FTRACE("%s", pCallbackData->pMessage);
             break;
     };
     return VK_FALSE;
@@ -104,10 +106,15 @@ b8 vulkanInit(rendererBackend* backend, const char* appName, u64 appWidth,
     FDEBUG("Width/Height: %d/%d", header.framebufferWidth,
            header.framebufferHeight);
 
+    // Headless there's no window to draw to, render offscreen instead
+    header.offscreen = platformIsHeadless();
+
     //--------Vulkan Extensions--------
     const char** requiredExts = dinoCreate(const char**);
-    dinoPush(requiredExts, &VK_KHR_SURFACE_EXTENSION_NAME);
-    platformGetRequiredExts(&requiredExts);
+    if (!header.offscreen) {
+        dinoPush(requiredExts, &VK_KHR_SURFACE_EXTENSION_NAME);
+        platformGetRequiredExts(&requiredExts);
+    }
 
     // Debug vulkan extensions
 #if defined(_DEBUG)
@@ -207,7 +214,9 @@ b8 vulkanInit(rendererBackend* backend, const char* appName, u64 appWidth,
     FDEBUG("Vulkan debugger created.");
 #endif
 
-    if (!platformCreateVulkanSurface(&header)) {
+    if (header.offscreen) {
+        FINFO("Rendering offscreen.");
+    } else if (!platformCreateVulkanSurface(&header)) {
         FERROR("Failed to create surface");
         return false;
     }
@@ -406,11 +415,13 @@ void vulkanShutdown(rendererBackend* backend) {
 
     vulkanDeviceDestroy(&header);
 
-    vkDestroySurfaceKHR(header.instance, header.surface, header.allocator);
+    if (header.surface) {
+        vkDestroySurfaceKHR(header.instance, header.surface, header.allocator);
+    }
     vkDestroyInstance(header.instance, header.allocator);
 }
 
-b8 vulkanDraw() {
+b8 vulkanDraw(const renderPacket* packet) {
     VkBuffer vertexBuffers[] = {header.vertexBuffer.handle};
     VkDeviceSize offsets[] = {0};
     vkCmdBindVertexBuffers(
@@ -419,7 +430,14 @@ b8 vulkanDraw() {
 
     vkCmdBindIndexBuffer(header.graphicsCommandBuffers[header.curImageIdx].handle, header.indicesBuffer.handle, 0, VK_INDEX_TYPE_UINT16);
 
-    vkCmdDrawIndexed(header.graphicsCommandBuffers[header.curImageIdx].handle, 6, 1, 0, 0, 0);
+    // The shader bound in vulkanBeginRenderpass
+    Shader* s = shaderGet("FirstShader");
+    mat4 viewProjection = mat4Mul(packet->view, packet->projection);
+    for (u32 i = 0; i < packet->drawCount; i++) {
+        mat4 mvp = mat4Mul(packet->draws[i].model, viewProjection);
+        vulkanShaderPushMatrix(s, &mvp);
+        vkCmdDrawIndexed(header.graphicsCommandBuffers[header.curImageIdx].handle, 6, 1, 0, 0, 0);
+    }
     // vkCmdDraw(header.graphicsCommandBuffers[header.curImageIdx].handle,
     //           header.vertexBuffer.bufferSize, 1, 0, 0);
 
@@ -427,6 +445,10 @@ b8 vulkanDraw() {
 }
 
 b8 vulkanOnResize(u16 width, u16 height) {
+    // Each new generation costs a swapchain rebuild on the next frame
+    if (width == header.framebufferWidth && height == header.framebufferHeight) {
+        return true;
+    }
     header.framebufferWidth = width;
     header.framebufferHeight = height;
     header.framebufferSizeGen++;
@@ -528,7 +550,7 @@ b8 vulkanBeginFrame(struct rendererBackend* backend, f32 deltaTime) {
             &header, &header.swapchain, UINT64_MAX,
             header.imageAvailableSemaphores[header.curFrame], 0,
             &header.curImageIdx)) {
-        FERROR("Failed to get next image idx");
+        FERROR_LIMITED(1, "Failed to get next image idx");
         return false;
     }
 
@@ -589,12 +611,15 @@ b8 vulkanEndFrame(struct rendererBackend* backend, f32 deltaTime) {
     VkSubmitInfo submitInfo = {VK_STRUCTURE_TYPE_SUBMIT_INFO};
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &cb->handle;
-    submitInfo.signalSemaphoreCount = 1;
-    submitInfo.pSignalSemaphores =
-        &header.renderFinishedSemaphores[header.curFrame];
-    submitInfo.waitSemaphoreCount = 1;
-    submitInfo.pWaitSemaphores =
-        &header.imageAvailableSemaphores[header.curFrame];
+    // Offscreen there's no acquire to wait on and no present to signal
+    if (!header.offscreen) {
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores =
+            &header.renderFinishedSemaphores[header.curFrame];
+        submitInfo.waitSemaphoreCount = 1;
+        submitInfo.pWaitSemaphores =
+            &header.imageAvailableSemaphores[header.curFrame];
+    }
 
     VkPipelineStageFlags flags[1] = {
         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
@@ -3,7 +3,7 @@
 b8 vulkanInit(rendererBackend* backend, const char* appName, u64 appWidth, u64 appHeight);
 void vulkanShutdown(rendererBackend* backend);
 
-b8 vulkanDraw();
+b8 vulkanDraw(const renderPacket* packet);
 b8 vulkanOnResize(u16 width, u16 height);
 
 b8 vulkanBeginFrame(struct rendererBackend* backend, f32 deltaTime);
@@ -1,6 +1,9 @@
 #include "vulkan/vulkan_core.h"
 #include "vulkanTypes.h"
 
+i32 findMemoryType(VulkanInfo* vi, u32 typeFilter,
+                   VkMemoryPropertyFlags props);
+
 b8 vulkanBufferCreate(VulkanInfo* vi, u64 size, b8 useFreelist,
                       VkBufferUsageFlags usageFlags,
                       VkMemoryPropertyFlags memProperties,
@@ -99,8 +99,12 @@ b8 vulkanPipelineCreate(VulkanInfo* vi, VulkanPipelineConfig vpc,
     plci.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
     plci.setLayoutCount = 0;
     plci.pSetLayouts = 0;
-    plci.pushConstantRangeCount = 0;
-    plci.pPushConstantRanges = 0;
+    VkPushConstantRange pushRange;
+    pushRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    pushRange.offset = 0;
+    pushRange.size = vpc.pushConstantSize;
+    plci.pushConstantRangeCount = vpc.pushConstantSize ? 1 : 0;
+    plci.pPushConstantRanges = vpc.pushConstantSize ? &pushRange : 0;
 
     VK_CHECK(vkCreatePipelineLayout(vi->device.device, &plci, vi->allocator,
                                     &outPipeline->layout));
@@ -13,6 +13,8 @@ typedef struct VulkanPipelineConfig {
     b8 isWireframe;
     b8 depthTested;
     VkVertexInputAttributeDescription* attributes;
+    // Bytes of push constants the vertex stage takes, 0 for none
+    u32 pushConstantSize;
 } VulkanPipelineConfig;
 
 b8 vulkanPipelineCreate(VulkanInfo* vi, VulkanPipelineConfig vpc, VulkanPipeline* outPipeline);
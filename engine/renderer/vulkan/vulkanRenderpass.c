@@ -32,9 +32,13 @@ b8 vulkanRenderpassCreate(VulkanInfo vi,
     colorAttachment.initialLayout =
         renderpassConfig.hasPrevPass ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
                                      : VK_IMAGE_LAYOUT_UNDEFINED;
+    // Offscreen images are left ready to be read back
+    VkImageLayout lastLayout = vi.offscreen
+                                   ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+                                   : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
     colorAttachment.finalLayout = renderpassConfig.hasNextPass
                                       ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
-                                      : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+                                      : lastLayout;
     colorAttachment.flags = 0;
 
     dinoPush(attachmentDescriptions, colorAttachment);
@@ -17,12 +17,9 @@ VkFormat convertIntoVulkanFormats(ShaderAttributeType type);
 b8 createShaderModule(VulkanInfo* header, const char* fileName,
                       VkShaderStageFlagBits stageFlagBits,
                       VulkanShaderStage* outShaderStage) {
-    char filename[512];
-    strFmt(filename, "%s", fileName);
-
     Resource binRes;
-    if (!resourceLoad(filename, RESOURCE_TYPE_BINARY, &binRes)) {
-        FERROR("Unable to read shader file: %s", filename);
+    if (!resourceLoad(fileName, RESOURCE_TYPE_BINARY, &binRes)) {
+        FERROR("Unable to read shader file: %s", fileName);
         return false;
     }
 
@@ -140,6 +137,8 @@ b8 vulkanShaderCreate(const ShaderRS* shaderConfig, Shader* outShader) {
     vpc.depthTested = false;
     vpc.renderpass = &vss->renderpass;
     vpc.attributes = attDescs;
+    // A draw's model * view * projection, see vulkanShaderPushMatrix
+    vpc.pushConstantSize = sizeof(mat4);
 
     FDEBUG("Create the pipeline")
     if (!vulkanPipelineCreate(vss, vpc, &vs->pipeline)) {
@@ -203,6 +202,12 @@ void vulkanShaderUse(Shader* shader) {
     vulkanPipelineBind(vss->graphicsCommandBuffers[vss->curImageIdx].handle, VK_PIPELINE_BIND_POINT_GRAPHICS, vs->pipeline.handle);
 }
 
+void vulkanShaderPushMatrix(Shader* shader, const mat4* matrix) {
+    VulkanShader* vs = (VulkanShader*)shader->rendererData;
+    vkCmdPushConstants(vss->graphicsCommandBuffers[vss->curImageIdx].handle, vs->pipeline.layout,
+                       VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(mat4), matrix);
+}
+
 b8 vulkanShaderApplyInstances(Shader* shader) {
     return false;
 }
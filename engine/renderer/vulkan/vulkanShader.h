@@ -14,6 +14,12 @@ b8 vulkanShaderDestroy(Shader* shader);
 
 void vulkanShaderUse(Shader* shader);
 
+/**
+ * @brief Sets the matrix the vertex stage transforms by for the draws
+ * recorded after it. The shader has to be in use.
+ */
+void vulkanShaderPushMatrix(Shader* shader, const mat4* matrix);
+
 b8 vulkanShaderApplyInstances(Shader* shader);
 b8 vulkanShaderApplyGlobals(Shader* shader);
 
@@ -4,12 +4,96 @@
 #include "device.h"
 #include "math/fsnmath.h"
 #include "renderer/vulkan/utils.h"
+#include "renderer/vulkan/vulkanBuffer.h"
 #include "renderer/vulkan/vulkanTypes.h"
 #include "vulkan/vulkan_core.h"
 #include "vulkanSwapchain.h"
 
+// Same number of images as framebuffers
+#define OFFSCREEN_IMAGE_CNT 3
+
+// Headless stand-in for a swapchain: plain device local images the frames
+// render into in turn, nothing ever presents them.
+static b8 offscreenCreate(VulkanInfo* header, u32 width, u32 height,
+                          VulkanSwapchain* outSwapchain) {
+    VkDevice device = header->device.device;
+    outSwapchain->imgFormat.format = VK_FORMAT_B8G8R8A8_UNORM;
+    outSwapchain->imgFormat.colorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
+    outSwapchain->handle = 0;
+    outSwapchain->imageCnt = OFFSCREEN_IMAGE_CNT;
+    outSwapchain->maxNumOfFramesInFlight = OFFSCREEN_IMAGE_CNT;
+    header->curFrame = 0;
+    header->curImageIdx = 0;
+
+    if (!outSwapchain->images) {
+        outSwapchain->images = (VkImage*)fallocate(
+            sizeof(VkImage) * OFFSCREEN_IMAGE_CNT, MEMORY_TAG_RENDERER);
+    }
+    if (!outSwapchain->views) {
+        outSwapchain->views = (VkImageView*)fallocate(
+            sizeof(VkImageView) * OFFSCREEN_IMAGE_CNT, MEMORY_TAG_RENDERER);
+    }
+
+    for (u32 i = 0; i < OFFSCREEN_IMAGE_CNT; ++i) {
+        VkImageCreateInfo imageInfo = {VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = outSwapchain->imgFormat.format;
+        imageInfo.extent = (VkExtent3D){width, height, 1};
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                          VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VK_CHECK(vkCreateImage(device, &imageInfo, header->allocator,
+                               &outSwapchain->images[i]));
+
+        VkMemoryRequirements memReq;
+        vkGetImageMemoryRequirements(device, outSwapchain->images[i], &memReq);
+        i32 memType = findMemoryType(header, memReq.memoryTypeBits,
+                                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        if (memType == -1) {
+            FERROR("No memory type fits the offscreen images.");
+            return false;
+        }
+        VkMemoryAllocateInfo allocInfo = {
+            VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+        allocInfo.allocationSize = memReq.size;
+        allocInfo.memoryTypeIndex = memType;
+        VK_CHECK(vkAllocateMemory(device, &allocInfo, header->allocator,
+                                  &outSwapchain->offscreenMemory[i]));
+        VK_CHECK(vkBindImageMemory(device, outSwapchain->images[i],
+                                   outSwapchain->offscreenMemory[i], 0));
+
+        VkImageViewCreateInfo viewInfo = {
+            VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
+        viewInfo.image = outSwapchain->images[i];
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = outSwapchain->imgFormat.format;
+        viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        viewInfo.subresourceRange.baseMipLevel = 0;
+        viewInfo.subresourceRange.baseArrayLayer = 0;
+        viewInfo.subresourceRange.levelCount = 1;
+        viewInfo.subresourceRange.layerCount = 1;
+        VK_CHECK(vkCreateImageView(device, &viewInfo, header->allocator,
+                                   &outSwapchain->views[i]));
+    }
+    FDEBUG("Offscreen images: %d of %dx%d", OFFSCREEN_IMAGE_CNT, width, height);
+
+    if (!vulkanDeviceDetectDepthFormat(&header->device)) {
+        FFATAL("Failed to get device depth format.");
+        return false;
+    }
+    return true;
+}
+
 b8 vulkanSwapchainCreate(VulkanInfo* header, u32 width, u32 height,
                          VulkanSwapchain* outSwapchain) {
+    if (header->offscreen) {
+        return offscreenCreate(header, width, height, outSwapchain);
+    }
 
     VulkanSwapchainSupportInfo* swapchainInfo = &header->device.swapchainSupport;
 
@@ -172,6 +256,16 @@ void vulkanSwapchainDestroy(VulkanInfo* header, VulkanSwapchain* swapchain) {
                            header->allocator);
     }
 
+    if (header->offscreen) {
+        for (u32 i = 0; i < swapchain->imageCnt; ++i) {
+            vkDestroyImage(header->device.device, swapchain->images[i],
+                           header->allocator);
+            vkFreeMemory(header->device.device, swapchain->offscreenMemory[i],
+                         header->allocator);
+        }
+        return;
+    }
+
     vkDestroySwapchainKHR(header->device.device, header->swapchain.handle,
                           header->allocator);
 }
@@ -179,6 +273,12 @@ void vulkanSwapchainDestroy(VulkanInfo* header, VulkanSwapchain* swapchain) {
 b8 vulkanSwapchainGetNextImgIdx(VulkanInfo* header, VulkanSwapchain* swapchain,
                                 u64 timeoutNS, VkSemaphore imgAvailSemaphore,
                                 VkFence fence, u32* outImgIdx) {
+    if (header->offscreen) {
+        // The frame's fence was waited on, so its image is free. Nothing
+        // signals imgAvailSemaphore, vulkanEndFrame doesn't wait on it then.
+        *outImgIdx = header->curFrame;
+        return true;
+    }
     vkAcquireNextImageKHR(header->device.device, swapchain->handle, timeoutNS,
                           imgAvailSemaphore, fence, outImgIdx);
     return true;
@@ -188,6 +288,11 @@ void vulkanSwapchainPresent(VulkanInfo* header, VulkanSwapchain* swapchain,
                             VkQueue graphicsQueue, VkQueue presentQueue,
                             VkSemaphore renderCompleteSemaphore,
                             u32 presentImgIdx) {
+    if (header->offscreen) {
+        header->curFrame =
+            (header->curFrame + 1) % swapchain->maxNumOfFramesInFlight;
+        return;
+    }
     VkPresentInfoKHR presentInfo = {VK_STRUCTURE_TYPE_PRESENT_INFO_KHR};
     presentInfo.waitSemaphoreCount = 1;
     presentInfo.pWaitSemaphores = &renderCompleteSemaphore;
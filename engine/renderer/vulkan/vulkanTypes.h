@@ -71,6 +71,9 @@ typedef struct VulkanSwapchain {
 
     // Framebuffers used for on-screen rendering, one per frame
     VkFramebuffer framebuffers[3];
+
+    // Offscreen the images are our own, this backs them. handle is null then.
+    VkDeviceMemory offscreenMemory[3];
 } VulkanSwapchain;
 
 typedef struct VulkanSwapchainSupportInfo {
@@ -151,6 +154,9 @@ typedef struct VulkanInfo {
     VkDebugUtilsMessengerEXT debugMessenger;
     VulkanDevice device;
     VkSurfaceKHR surface;
+    // Headless: no surface, the swapchain is a ring of plain images and
+    // nothing is presented.
+    b8 offscreen;
     VulkanSwapchain swapchain;
     u32 framebufferWidth;
     u32 framebufferHeight;
@@ -3,6 +3,7 @@
 #include "core/fmemory.h"
 #include "core/logger.h"
 #include "core/fstring.h"
+#include "core/strBuilder.h"
 #include "resources/resourceManager.h"
 #include "resources/resourcesTypes.h"
 
@@ -14,18 +15,25 @@ b8 binaryManagerLoad(resourceManager* self, const char* name, Resource* outRes){
         return false;
     }
 
-    char* fmtStr = "%s/%s%s";
-    char path[512];
-    strFmt(path, fmtStr, resourceManagerRootAssetPath(), name, "");
+    char buffer[256];
+    strBuilder sb;
+    strBuilderInit(&sb, buffer, sizeof(buffer));
+    strBuilderAppend(&sb, resourceManagerRootAssetPath());
+    strBuilderAppendChar(&sb, '/');
+    strBuilderAppend(&sb, name);
+    const char* path = strBuilderCStr(&sb);
     FTRACE("Binary Path: %s", path);
 
     fileHandle fh;
     if (!fsOpen(path, FILE_MODE_READ, true, &fh)){
         FERROR("Binary Manager unable to load binary file: %s", path);
+        strBuilderDestroy(&sb);
         return false;
     }
 
     outRes->fullPath = strDup(path);
+    strBuilderDestroy(&sb);
+    path = outRes->fullPath;
 
     u64 fileSize = 0;
     if (!fsSize(&fh, &fileSize)){
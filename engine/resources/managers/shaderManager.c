@@ -2,6 +2,7 @@
 #include "core/fmemory.h"
 #include "core/fstring.h"
 #include "core/logger.h"
+#include "core/strBuilder.h"
 #include "defines.h"
 #include "helpers/dinoarray.h"
 #include "platform/filesystem.h"
@@ -10,16 +11,22 @@
 
 b8 shaderManagerLoad(resourceManager* self, const char* name,
                      Resource* outResource) {
-    char* fmtStr = "%s%s";
-    char fileLocation[512];
-    strFmt(fileLocation, fmtStr, resourceManagerRootAssetPath(), name);
+    char buffer[256];
+    strBuilder sb;
+    strBuilderInit(&sb, buffer, sizeof(buffer));
+    strBuilderAppend(&sb, resourceManagerRootAssetPath());
+    strBuilderAppend(&sb, name);
+    const char* fileLocation = strBuilderCStr(&sb);
     FDEBUG("File Location: %s", fileLocation)
     fileHandle f;
     if (!fsOpen(fileLocation, FILE_MODE_READ, false, &f)) {
         FERROR("Could not open file: %s", fileLocation);
+        strBuilderDestroy(&sb);
         return false;
     }
     outResource->fullPath = strDup(fileLocation);
+    strBuilderDestroy(&sb);
+    fileLocation = outResource->fullPath;
 
     ShaderRS* r = fallocate(sizeof(ShaderRS), MEMORY_TAG_RESOURCE);
     r->name = 0;
@@ -39,19 +46,18 @@ b8 shaderManagerLoad(resourceManager* self, const char* name,
     char* p = &line[0];
     u64 lineLen = 0;
     while (fsReadLine(&f, 511, &p, &lineLen)) {
-        char* ln = strTrim(line);
-        lineLen = strLen(ln);
+        strView ln = strTrimView(strViewMake(line, lineLen));
 
-        if (lineLen < 1 || ln[0] == '#') {
+        if (ln.len < 1 || ln.ptr[0] == '#') {
             continue;
         }
 
-        i32 equalIdx = strIdxOf(ln, '=');
+        i64 equalIdx = strIdxOfView(ln, '=');
         if (equalIdx == -1 && !uniformStarted && !attributeStarted) {
-            if (strEqualI(ln, "UNIFORMS")){
+            if (strViewEqualICStr(ln, "UNIFORMS")){
                 uniformStarted = true;
                 attributeStarted = false;
-            }else if (strEqualI(ln, "ATTRIBUTES")){
+            }else if (strViewEqualICStr(ln, "ATTRIBUTES")){
                 uniformStarted = false;
                 attributeStarted = true;
             }else{
@@ -60,23 +66,19 @@ b8 shaderManagerLoad(resourceManager* self, const char* name,
             continue;
         }
 
-        char varName[64];
-        fzeroMemory(varName, sizeof(char) * 64);
-        strCut(varName, ln, 0, equalIdx);
-        char* tvar = strTrim(varName);
+        // Attribute/uniform lines have no '=' so the whole line is the value
+        strView tvar = strTrimView(strViewSub(ln, 0, equalIdx));
+        strView tval = strTrimView(strViewSub(ln, equalIdx + 1, -1));
 
-        char value[446];
-        fzeroMemory(value, sizeof(char) * 446);
-        strCut(value, ln, equalIdx + 1, -1);
-        char* tval = strTrim(value);
-
-        if (strEqualI(tvar, "Name")) {
-            r->name = strDup(tval);
-        } else if (strEqualI(tvar, "renderpass")) {
-            r->renderpassName = strDup(tval);
-        } else if (strEqualI(tvar, "stages")) {
-            r->stageCnt = strSplit(tval, ',', &r->stageNames, true, true);
+        if (strViewEqualICStr(tvar, "Name")) {
+            r->name = strViewDup(tval);
+        } else if (strViewEqualICStr(tvar, "renderpass")) {
+            r->renderpassName = strViewDup(tval);
+        } else if (strViewEqualICStr(tvar, "stages")) {
+            strView stages[SHADER_MAX_STAGES];
+            r->stageCnt = strSplitView(tval, ',', stages, SHADER_MAX_STAGES, true, true);
             for (u8 i = 0; i < r->stageCnt; i++) {
+                dinoPush(r->stageNames, strViewDup(stages[i]));
                 if (strSub(r->stageNames[i], "frag")) {
                     dinoPush(r->stages, SHADER_STAGE_FRAGMENT);
                 } else if (strSub(r->stageNames[i], "vert")) {
@@ -87,16 +89,20 @@ b8 shaderManagerLoad(resourceManager* self, const char* name,
                     dinoPush(r->stages, SHADER_STAGE_COMPUTE);
                 }
             }
-        } else if (strEqualI(tvar, "stagefiles")) {
-            r->stageCnt = strSplit(tval, ',', &r->stageFiles, true, true);
-        } else if (strEqualI(tvar, "supportsInstances")) {
-            strToBool(tval, &r->supportsInstances);
-        } else if (strEqualI(tvar, "supportsLocals")) {
-            strToBool(tval, &r->supportsLocals);
-        } else if (strEqualI(tvar, "ATTRIBUTES")) {
+        } else if (strViewEqualICStr(tvar, "stagefiles")) {
+            strView files[SHADER_MAX_STAGES];
+            r->stageCnt = strSplitView(tval, ',', files, SHADER_MAX_STAGES, true, true);
+            for (u8 i = 0; i < r->stageCnt; i++) {
+                dinoPush(r->stageFiles, strViewDup(files[i]));
+            }
+        } else if (strViewEqualICStr(tvar, "supportsInstances")) {
+            r->supportsInstances = strViewEqualCStr(tval, "1") || strViewEqualICStr(tval, "true");
+        } else if (strViewEqualICStr(tvar, "supportsLocals")) {
+            r->supportsLocals = strViewEqualCStr(tval, "1") || strViewEqualICStr(tval, "true");
+        } else if (strViewEqualICStr(tvar, "ATTRIBUTES")) {
             attributeStarted = true;
             uniformStarted = false;
-        } else if (strEqualI(tvar, "UNIFORMS")) {
+        } else if (strViewEqualICStr(tvar, "UNIFORMS")) {
             attributeStarted = false;
             uniformStarted = true;
         } else {
@@ -104,46 +110,46 @@ b8 shaderManagerLoad(resourceManager* self, const char* name,
                 if (!r->attributes){
                     r->attributes = dinoCreate(ShaderAttributeConfig);
                 }
-                char** fields = dinoCreate(char*);
-                u32 fieldAmt = strSplit(tval, ' ', &fields, true, true);
+                strView fields[3];
+                u32 fieldAmt = strSplitView(tval, ' ', fields, 3, true, false);
                 if (fieldAmt != 2) {
                     FERROR("ShaderCfg %s: Incorrect attribute syntax", r->name);
                     continue;
                 }
                 ShaderAttributeConfig at;
 
-                at.name = strDup(fields[0]);
-                at.nameLen = strLen(fields[0]);
+                at.name = strViewDup(fields[0]);
+                at.nameLen = fields[0].len;
 
                 // Parse field type
-                if (strEqualI(fields[1], "i8")) {
+                if (strViewEqualICStr(fields[1], "i8")) {
                     at.type = SHADER_ATTRIBUTE_TYPE_INT8;
                     at.size = 1;
-                } else if (strEqualI(fields[1], "i16")) {
+                } else if (strViewEqualICStr(fields[1], "i16")) {
                     at.type = SHADER_ATTRIBUTE_TYPE_INT16;
                     at.size = 2;
-                } else if (strEqualI(fields[1], "i32")) {
+                } else if (strViewEqualICStr(fields[1], "i32")) {
                     at.type = SHADER_ATTRIBUTE_TYPE_INT32;
                     at.size = 4;
-                } else if (strEqualI(fields[1], "u8")) {
+                } else if (strViewEqualICStr(fields[1], "u8")) {
                     at.type = SHADER_ATTRIBUTE_TYPE_UINT8;
                     at.size = 1;
-                } else if (strEqualI(fields[1], "u16")) {
+                } else if (strViewEqualICStr(fields[1], "u16")) {
                     at.type = SHADER_ATTRIBUTE_TYPE_UINT16;
                     at.size = 2;
-                } else if (strEqualI(fields[1], "u32")) {
+                } else if (strViewEqualICStr(fields[1], "u32")) {
                     at.type = SHADER_ATTRIBUTE_TYPE_UINT32;
                     at.size = 4;
-                } else if (strEqualI(fields[1], "f32")) {
+                } else if (strViewEqualICStr(fields[1], "f32")) {
                     at.type = SHADER_ATTRIBUTE_TYPE_FLOAT32;
                     at.size = 4;
-                } else if (strEqualI(fields[1], "vec2")) {
+                } else if (strViewEqualICStr(fields[1], "vec2")) {
                     at.type = SHADER_ATTRIBUTE_TYPE_FLOAT32_2;
                     at.size = 8;
-                } else if (strEqualI(fields[1], "vec3")) {
+                } else if (strViewEqualICStr(fields[1], "vec3")) {
                     at.type = SHADER_ATTRIBUTE_TYPE_FLOAT32_3;
                     at.size = 12;
-                } else if (strEqualI(fields[1], "vec4")) {
+                } else if (strViewEqualICStr(fields[1], "vec4")) {
                     at.type = SHADER_ATTRIBUTE_TYPE_FLOAT32_4;
                     at.size = 16;
                 } else {
@@ -155,73 +161,70 @@ b8 shaderManagerLoad(resourceManager* self, const char* name,
                 }
                 dinoPush(r->attributes, at);
                 r->attributeCnt++;
-
-                strCleanDinoArray(fields);
-                dinoDestroy(fields);
             } else if (uniformStarted) {
                 if (!r->uniforms){
                     r->uniforms = dinoCreate(ShaderUniformConfig);
                 }
-                char** fields = dinoCreate(char*);
-                u32 fieldAmt = strSplit(tval, ' ', &fields, true, true);
+                strView fields[4];
+                u32 fieldAmt = strSplitView(tval, ' ', fields, 4, true, false);
                 if (fieldAmt != 3) {
                     FERROR("ShaderCfg %s: Incorrect uniform syntax", r->name);
                     continue;
                 }
                 ShaderUniformConfig un;
                 // Parse field type
-                un.name = strDup(fields[0]);
-                un.nameLen = strLen(fields[0]);
+                un.name = strViewDup(fields[0]);
+                un.nameLen = fields[0].len;
 
-                if (strEqualI(fields[1], "3")) {
+                if (strViewEqualCStr(fields[1], "3")) {
                     un.scope = SHADER_SCOPE_GLOBAL;
-                } else if (strEqualI(fields[1], "2")) {
+                } else if (strViewEqualCStr(fields[1], "2")) {
                     un.scope = SHADER_SCOPE_INSTANCE;
-                } else if (strEqualI(fields[1], "1")) {
+                } else if (strViewEqualCStr(fields[1], "1")) {
                     un.scope = SHADER_SCOPE_LOCAL;
                 }
 
-                if (strEqualI(fields[2], "i8")) {
+                if (strViewEqualICStr(fields[2], "i8")) {
                     un.type = SHADER_UNIFORM_TYPE_INT8;
                     un.size = 1;
-                } else if (strEqualI(fields[2], "i16")) {
+                } else if (strViewEqualICStr(fields[2], "i16")) {
                     un.type = SHADER_UNIFORM_TYPE_INT16;
                     un.size = 2;
-                } else if (strEqualI(fields[2], "i32")) {
+                } else if (strViewEqualICStr(fields[2], "i32")) {
                     un.type = SHADER_UNIFORM_TYPE_INT32;
                     un.size = 4;
-                } else if (strEqualI(fields[2], "u8")) {
+                } else if (strViewEqualICStr(fields[2], "u8")) {
                     un.type = SHADER_UNIFORM_TYPE_UINT8;
                     un.size = 1;
-                } else if (strEqualI(fields[2], "u16")) {
+                } else if (strViewEqualICStr(fields[2], "u16")) {
                     un.type = SHADER_UNIFORM_TYPE_UINT16;
                     un.size = 2;
-                } else if (strEqualI(fields[2], "u32")) {
+                } else if (strViewEqualICStr(fields[2], "u32")) {
                     un.type = SHADER_UNIFORM_TYPE_UINT32;
                     un.size = 4;
-                } else if (strEqualI(fields[2], "f32")) {
+                } else if (strViewEqualICStr(fields[2], "f32")) {
                     un.type = SHADER_UNIFORM_TYPE_FLOAT32;
                     un.size = 4;
-                } else if (strEqualI(fields[2], "vec2")) {
+                } else if (strViewEqualICStr(fields[2], "vec2")) {
                     un.type = SHADER_UNIFORM_TYPE_FLOAT32_2;
                     un.size = 8;
-                } else if (strEqualI(fields[2], "vec3")) {
+                } else if (strViewEqualICStr(fields[2], "vec3")) {
                     un.type = SHADER_UNIFORM_TYPE_FLOAT32_3;
                     un.size = 12;
-                } else if (strEqualI(fields[2], "vec4")) {
+                } else if (strViewEqualICStr(fields[2], "vec4")) {
                     un.type = SHADER_UNIFORM_TYPE_FLOAT32_4;
                     un.size = 16;
-                } else if (strEqualI(fields[2], "mat4")) {
+                } else if (strViewEqualICStr(fields[2], "mat4")) {
                     un.type = SHADER_UNIFORM_TYPE_MATRIX_4;
                     un.size = 64;
-                } else if (strEqualI(fields[2], "sampler") ||
-                           strEqualI(fields[2], "samp")) {
+                } else if (strViewEqualICStr(fields[2], "sampler") ||
+                           strViewEqualICStr(fields[2], "samp")) {
                     un.type = SHADER_UNIFORM_TYPE_SAMPLER;
                     un.size = 0;
                     FINFO("Sampler read");
                 } else {
-                    FERROR("ShaderCfg %s: Invalid uniform type used. %s",
-                           r->name, fields[2]);
+                    FERROR("ShaderCfg %s: Invalid uniform type used. %.*s",
+                           r->name, (i32)fields[2].len, fields[2].ptr);
                     FWARN("Defaulting to f32.");
                     un.type = SHADER_UNIFORM_TYPE_FLOAT32;
                     un.size = 4;
@@ -229,12 +232,8 @@ b8 shaderManagerLoad(resourceManager* self, const char* name,
 
                 dinoPush(r->uniforms, un);
                 r->uniformCnt++;
-
-                strCleanDinoArray(fields);
-                dinoDestroy(fields);
             }
         }
-        fzeroMemory(ln, sizeof(char) * 512);
     }
     fsClose(&f);
     outResource->data = r;
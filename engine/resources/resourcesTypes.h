@@ -7,6 +7,7 @@
 #define MATERIAL_MAX_LENGTH 256
 #define TEXTURE_MAX_TEXTURES 1024
 #define MAX_MATERIAL_COUNT 1024
+#define SHADER_MAX_STAGES 8
 
 typedef enum ResourceType {
     RESOURCE_TYPE_TEXT = 0,
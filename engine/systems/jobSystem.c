@@ -0,0 +1,496 @@
+#include "jobSystem.h"
+
+#include "core/fmemory.h"
+#include "core/fstring.h"
+#include "core/logger.h"
+#include "helpers/ringbuffer.h"
+#include "platform/platform.h"
+
+/*
+ * The deques are the Chase-Lev deque as written for C11 atomics by Le,
+ * Pop, Cohen and Zappa Nardelli ("Correct and Efficient Work-Stealing for
+ * Weak Memory Models"), fixed size instead of growing.
+ *
+ * Slots are atomics too: a thief reads its slot before it knows whether its
+ * CAS on top will win, and the owner may be reusing that slot by then. The
+ * CAS fails in exactly those cases, so whatever it read gets thrown away,
+ * but the read mustn't be a data race.
+ */
+
+// Most workers there can be, the affinity mask is 64 bits
+#define JOB_MAX_WORKERS 64
+// Jobs from threads that aren't workers waiting to be picked up
+#define JOB_INJECT_CAPACITY 4096
+// Times an idle worker looks around for work before going to sleep
+#define JOB_IDLE_SPINS 64
+// Flag on jobCounter.pending, see jobWait
+#define JOB_COUNTER_PARKED (1 << 30)
+// How long threads that aren't workers sleep between looks at a counter
+#define JOB_POLL_NS 50000
+
+#define ALIGN_UP(value, alignment)                                             \
+    (((value) + ((alignment)-1)) & ~((u64)(alignment)-1))
+
+typedef struct job {
+    pfnJob fn;
+    void* data;
+    jobCounter* counter;
+} job;
+
+typedef struct jobSlot {
+    _Atomic(pfnJob) fn;
+    _Atomic(void*) data;
+    _Atomic(jobCounter*) counter;
+} jobSlot;
+
+typedef struct jobWorker {
+    // Only written by the owner
+    _Atomic i64 bottom;
+    u8 ownerPad[FSN_CACHE_LINE_SIZE - sizeof(i64)];
+
+    // Moved on by thieves, and by the owner taking its last job
+    _Atomic i64 top;
+    u8 thiefPad[FSN_CACHE_LINE_SIZE - sizeof(i64)];
+
+    // Read only after init, other than victim which only the owner uses
+    jobSlot* slots;
+    platformThread thread;
+    // What jobWait sleeps on
+    platformSemaphore parked;
+    u32 idx;
+    // Where the next round of stealing starts
+    u32 victim;
+    u8 sharedPad[FSN_CACHE_LINE_SIZE - sizeof(jobSlot*) - sizeof(platformThread) -
+                 sizeof(platformSemaphore) - sizeof(u32) * 2];
+} jobWorker;
+
+STATIC_ASSERT(sizeof(jobWorker) % FSN_CACHE_LINE_SIZE == 0,
+              "jobWorker has to fill whole cache lines");
+
+typedef struct jobSystemState {
+    jobSystemSettings settings;
+    // Including worker 0, the thread that called jobSystemInit
+    u32 workerCount;
+    i64 slotMask;
+    jobWorker* workers;
+    // Jobs from threads that aren't workers
+    mpmcRing inject;
+
+    _Atomic b8 running;
+    // Workers asleep on wake (or about to be)
+    _Atomic i32 sleeping;
+    platformSemaphore wake;
+} jobSystemState;
+
+static jobSystemState* systemPtr = 0;
+
+// The calling thread's worker, 0 on threads that aren't workers
+static FSN_THREAD_LOCAL jobWorker* localWorker;
+
+static u32 resolveWorkerCount(jobSystemSettings settings) {
+    u32 threads = settings.workerCount;
+    if (threads == INVALID_ID) {
+        threads = platformGetProcessorCount() - 1;
+    }
+    if (threads > JOB_MAX_WORKERS - 1) {
+        threads = JOB_MAX_WORKERS - 1;
+    }
+    return threads + 1;
+}
+
+static u32 resolveSlotCount(jobSystemSettings settings) {
+    u32 slots = 1;
+    while (slots < settings.maxJobsPerWorker) {
+        slots <<= 1;
+    }
+    return slots;
+}
+
+//==================== Deque ====================
+
+// Owner only
+static b8 dequePush(jobWorker* w, const job* j) {
+    i64 b = atomic_load_explicit(&w->bottom, memory_order_relaxed);
+    i64 t = atomic_load_explicit(&w->top, memory_order_acquire);
+    if (b - t > systemPtr->slotMask) {
+        return false;
+    }
+    jobSlot* slot = &w->slots[b & systemPtr->slotMask];
+    atomic_store_explicit(&slot->fn, j->fn, memory_order_relaxed);
+    atomic_store_explicit(&slot->data, j->data, memory_order_relaxed);
+    atomic_store_explicit(&slot->counter, j->counter, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&w->bottom, b + 1, memory_order_relaxed);
+    return true;
+}
+
+static void slotRead(jobWorker* w, i64 idx, job* outJob) {
+    jobSlot* slot = &w->slots[idx & systemPtr->slotMask];
+    outJob->fn = atomic_load_explicit(&slot->fn, memory_order_relaxed);
+    outJob->data = atomic_load_explicit(&slot->data, memory_order_relaxed);
+    outJob->counter = atomic_load_explicit(&slot->counter, memory_order_relaxed);
+}
+
+// Owner only, newest first
+static b8 dequePop(jobWorker* w, job* outJob) {
+    i64 b = atomic_load_explicit(&w->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&w->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    i64 t = atomic_load_explicit(&w->top, memory_order_relaxed);
+
+    if (t > b) {
+        // Empty
+        atomic_store_explicit(&w->bottom, b + 1, memory_order_relaxed);
+        return false;
+    }
+    slotRead(w, b, outJob);
+    if (t == b) {
+        // Last one, race the thieves for it
+        b8 won = atomic_compare_exchange_strong_explicit(
+            &w->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed);
+        atomic_store_explicit(&w->bottom, b + 1, memory_order_relaxed);
+        return won;
+    }
+    return true;
+}
+
+// Any thread, oldest first
+static b8 dequeSteal(jobWorker* w, job* outJob) {
+    i64 t = atomic_load_explicit(&w->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    i64 b = atomic_load_explicit(&w->bottom, memory_order_acquire);
+    if (t >= b) {
+        return false;
+    }
+    slotRead(w, t, outJob);
+    return atomic_compare_exchange_strong_explicit(
+        &w->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed);
+}
+
+//==================== Scheduling ====================
+
+static b8 findJob(job* outJob) {
+    jobWorker* self = localWorker;
+    if (self && dequePop(self, outJob)) {
+        return true;
+    }
+    if (mpmcRingPop(&systemPtr->inject, outJob)) {
+        return true;
+    }
+
+    u32 count = systemPtr->workerCount;
+    u32 start = self ? self->victim : 0;
+    for (u32 i = 0; i < count; i++) {
+        jobWorker* victim = &systemPtr->workers[(start + i) % count];
+        if (victim == self) {
+            continue;
+        }
+        if (dequeSteal(victim, outJob)) {
+            if (self) {
+                // Come back to the one that had work first next time
+                self->victim = victim->idx;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+static void runJob(const job* j) {
+    j->fn(j->data);
+    if (!j->counter) {
+        return;
+    }
+    // Once it's 0 the waiter may return and the counter go away, unless the
+    // waiter is parked. Then it only wakes from the signal, so the counter is
+    // still there to read.
+    i32 pending = atomic_fetch_sub_explicit(&j->counter->pending, 1, memory_order_acq_rel);
+    if (pending == (JOB_COUNTER_PARKED | 1)) {
+        platformSemaphoreSignal(j->counter->waiter, 1);
+    }
+}
+
+static void wakeWorkers(u32 count) {
+    // Pairs with the seq_cst increment of sleeping in workerMain. Either the
+    // worker sees the new job before it sleeps or this sees the worker.
+    atomic_thread_fence(memory_order_seq_cst);
+    i32 sleeping = atomic_load_explicit(&systemPtr->sleeping, memory_order_relaxed);
+    if (sleeping > 0) {
+        platformSemaphoreSignal(&systemPtr->wake,
+                                (u32)sleeping < count ? (u32)sleeping : count);
+    }
+}
+
+// Queues j, false if it had to be run right away instead
+static b8 submit(const job* j) {
+    jobWorker* self = localWorker;
+    b8 queued = self ? dequePush(self, j) : mpmcRingPush(&systemPtr->inject, j);
+    if (!queued) {
+        runJob(j);
+    }
+    return queued;
+}
+
+static u32 workerMain(void* params) {
+    jobWorker* self = params;
+    localWorker = self;
+
+    char name[16];
+    strFmt(name, "fsnJob%u", self->idx);
+    platformThreadSetName(name);
+
+    job j;
+    u32 idle = 0;
+    while (atomic_load_explicit(&systemPtr->running, memory_order_acquire)) {
+        if (findJob(&j)) {
+            runJob(&j);
+            idle = 0;
+            continue;
+        }
+        if (++idle < JOB_IDLE_SPINS) {
+            FSN_CPU_RELAX();
+            continue;
+        }
+
+        atomic_fetch_add_explicit(&systemPtr->sleeping, 1, memory_order_seq_cst);
+        // Last look now that submitters can see this worker is sleeping
+        if (findJob(&j)) {
+            atomic_fetch_sub_explicit(&systemPtr->sleeping, 1, memory_order_relaxed);
+            runJob(&j);
+            idle = 0;
+            continue;
+        }
+        if (atomic_load_explicit(&systemPtr->running, memory_order_acquire)) {
+            platformSemaphoreWait(&systemPtr->wake, PLATFORM_WAIT_INFINITE);
+        }
+        atomic_fetch_sub_explicit(&systemPtr->sleeping, 1, memory_order_relaxed);
+        idle = 0;
+    }
+    localWorker = 0;
+    return 0;
+}
+
+//==================== API ====================
+
+b8 jobSystemInit(u64* memoryReq, void* memory, jobSystemSettings settings) {
+    u32 workerCount = resolveWorkerCount(settings);
+    u32 slotCount = resolveSlotCount(settings);
+    u64 stateReq = ALIGN_UP(sizeof(jobSystemState), FSN_CACHE_LINE_SIZE);
+    u64 workersReq = sizeof(jobWorker) * workerCount;
+    u64 slotsReq = sizeof(jobSlot) * slotCount * workerCount;
+    // fallocate doesn't align, the workers are lined up on a cache line by hand
+    *memoryReq = stateReq + FSN_CACHE_LINE_SIZE + workersReq + slotsReq;
+
+    if (!memory) {
+        return true;
+    }
+
+    fzeroMemory(memory, *memoryReq);
+    systemPtr = memory;
+    systemPtr->settings = settings;
+    systemPtr->workerCount = workerCount;
+    systemPtr->slotMask = slotCount - 1;
+    systemPtr->workers =
+        (jobWorker*)ALIGN_UP((u64)memory + stateReq, FSN_CACHE_LINE_SIZE);
+    jobSlot* slots = (jobSlot*)((u64)systemPtr->workers + workersReq);
+
+    if (!mpmcRingCreate(sizeof(job), JOB_INJECT_CAPACITY, &systemPtr->inject) ||
+        !platformSemaphoreCreate(0, &systemPtr->wake)) {
+        FERROR("Job system failed to create its queues.");
+        return false;
+    }
+    atomic_store(&systemPtr->running, true);
+
+    for (u32 i = 0; i < workerCount; i++) {
+        jobWorker* w = &systemPtr->workers[i];
+        w->idx = i;
+        w->victim = (i + 1) % workerCount;
+        w->slots = slots + (u64)i * slotCount;
+        if (!platformSemaphoreCreate(0, &w->parked)) {
+            FERROR("Job system failed to create its semaphores.");
+            return false;
+        }
+    }
+
+    localWorker = &systemPtr->workers[0];
+    u32 cpuCount = platformGetProcessorCount();
+    for (u32 i = 1; i < workerCount; i++) {
+        jobWorker* w = &systemPtr->workers[i];
+        if (!platformThreadCreate(workerMain, w, &w->thread)) {
+            FERROR("Job system failed to start worker %u.", i);
+            // The rest still get stolen from by the ones that did start
+            continue;
+        }
+        if (settings.pinWorkers &&
+            !platformThreadSetAffinity(&w->thread, 1ull << (i % cpuCount))) {
+            FWARN("Couldn't pin job worker %u.", i);
+        }
+    }
+
+    FINFO("Job system started with %u workers.", workerCount);
+    return true;
+}
+
+void jobSystemShutdown() {
+    if (!systemPtr) {
+        return;
+    }
+    job j;
+    while (findJob(&j)) {
+        runJob(&j);
+    }
+
+    atomic_store_explicit(&systemPtr->running, false, memory_order_release);
+    platformSemaphoreSignal(&systemPtr->wake, systemPtr->workerCount);
+    for (u32 i = 1; i < systemPtr->workerCount; i++) {
+        platformThreadJoin(&systemPtr->workers[i].thread);
+    }
+    // Anything the workers queued on their way out
+    while (findJob(&j)) {
+        runJob(&j);
+    }
+
+    localWorker = 0;
+    for (u32 i = 0; i < systemPtr->workerCount; i++) {
+        platformSemaphoreDestroy(&systemPtr->workers[i].parked);
+    }
+    mpmcRingDestroy(&systemPtr->inject);
+    platformSemaphoreDestroy(&systemPtr->wake);
+    systemPtr = 0;
+}
+
+u32 jobSystemWorkerCount() {
+    return systemPtr ? systemPtr->workerCount : 1;
+}
+
+void jobRun(pfnJob fn, void* data, jobCounter* counter) {
+    job j = {fn, data, counter};
+    if (counter) {
+        atomic_fetch_add_explicit(&counter->pending, 1, memory_order_relaxed);
+    }
+    if (!systemPtr) {
+        runJob(&j);
+        return;
+    }
+    if (submit(&j)) {
+        wakeWorkers(1);
+    }
+}
+
+void jobRunMany(const jobDecl* jobs, u32 count, jobCounter* counter) {
+    if (counter) {
+        atomic_fetch_add_explicit(&counter->pending, (i32)count, memory_order_relaxed);
+    }
+    u32 queued = 0;
+    for (u32 i = 0; i < count; i++) {
+        job j = {jobs[i].fn, jobs[i].data, counter};
+        if (!systemPtr) {
+            runJob(&j);
+        } else if (submit(&j)) {
+            queued++;
+        }
+    }
+    if (queued) {
+        wakeWorkers(queued);
+    }
+}
+
+void jobWait(jobCounter* counter) {
+    job j;
+    u32 idle = 0;
+    for (;;) {
+        i32 pending = atomic_load_explicit(&counter->pending, memory_order_acquire);
+        if (pending <= 0) {
+            return;
+        }
+        if (systemPtr && findJob(&j)) {
+            runJob(&j);
+            idle = 0;
+            continue;
+        }
+        if (++idle < JOB_IDLE_SPINS) {
+            FSN_CPU_RELAX();
+            continue;
+        }
+
+        // The rest are running on other workers, or sitting in their deques
+        // for them to get to. Nothing else can end up in this one's.
+        jobWorker* self = localWorker;
+        if (!self) {
+            platformSleepNs(JOB_POLL_NS);
+            continue;
+        }
+        counter->waiter = &self->parked;
+        if (atomic_compare_exchange_strong_explicit(&counter->pending, &pending,
+                                                    pending | JOB_COUNTER_PARKED,
+                                                    memory_order_acq_rel,
+                                                    memory_order_acquire)) {
+            platformSemaphoreWait(&self->parked, PLATFORM_WAIT_INFINITE);
+            atomic_store_explicit(&counter->pending, 0, memory_order_relaxed);
+            return;
+        }
+        // Changed in the meantime, look again
+        idle = 0;
+    }
+}
+
+b8 jobTryRun() {
+    job j;
+    if (!systemPtr || !findJob(&j)) {
+        return false;
+    }
+    runJob(&j);
+    return true;
+}
+
+typedef struct parallelFor {
+    pfnParallelFor fn;
+    void* userData;
+    u32 count;
+    u32 grain;
+    // Start of the next range nobody has taken yet
+    _Atomic u64 next;
+} parallelFor;
+
+// Every helper takes ranges until there are none left, so a slow range
+// doesn't hold up the ones behind it.
+static void parallelForJob(void* data) {
+    parallelFor* pf = data;
+    for (;;) {
+        u64 start = atomic_fetch_add_explicit(&pf->next, pf->grain, memory_order_relaxed);
+        if (start >= pf->count) {
+            return;
+        }
+        u64 end = start + pf->grain;
+        pf->fn((u32)start, end < pf->count ? (u32)end : pf->count, pf->userData);
+    }
+}
+
+void jobParallelFor(u32 count, u32 grain, pfnParallelFor fn, void* userData) {
+    if (!count) {
+        return;
+    }
+    u32 workers = jobSystemWorkerCount();
+    if (!grain) {
+        // A few ranges per worker, enough to even out uneven ones
+        grain = count / (workers * 4);
+        grain = grain ? grain : 1;
+    }
+
+    parallelFor pf;
+    pf.fn = fn;
+    pf.userData = userData;
+    pf.count = count;
+    pf.grain = grain;
+    atomic_init(&pf.next, 0);
+
+    u32 ranges = (count + grain - 1) / grain;
+    u32 helpers = (ranges < workers ? ranges : workers) - 1;
+    jobCounter counter;
+    atomic_init(&counter.pending, 0);
+    for (u32 i = 0; i < helpers; i++) {
+        jobRun(parallelForJob, &pf, &counter);
+    }
+    parallelForJob(&pf);
+    jobWait(&counter);
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "defines.h"
+
+#include <stdatomic.h>
+
+/**
+ *  Work-stealing job system. The thread that calls jobSystemInit is worker
+ * 0, and jobSystemSettings.workerCount more threads are started next to it.
+ * Every worker has its own Chase-Lev deque: it pushes and pops its own jobs
+ * at the bottom without contention, idle workers steal from the top of the
+ * others'. Jobs submitted from threads that aren't workers go through a
+ * shared queue instead. Workers with nothing to do sleep until there is.
+ *
+ *  Jobs report to an optional jobCounter, jobWait blocks until a counter
+ * reaches 0 and runs other jobs in the meantime, so it's fine to wait from
+ * inside a job.
+ */
+
+typedef struct jobSystemSettings {
+    // Threads started besides the calling one. INVALID_ID for one per CPU
+    // left over.
+    u32 workerCount;
+    // Jobs each worker's deque can hold. Rounded up to a power of 2. A job
+    // that doesn't fit runs right away on the submitting thread.
+    u32 maxJobsPerWorker;
+    // Pin worker n to CPU n
+    b8 pinWorkers;
+} jobSystemSettings;
+
+typedef void (*pfnJob)(void* data);
+
+typedef struct jobCounter {
+    // Jobs still to finish, plus JOB_COUNTER_PARKED while a jobWait sleeps
+    // on it
+    _Atomic i32 pending;
+    // Set by the sleeping jobWait, signalled by whoever finishes the last job
+    struct platformSemaphore* waiter;
+} jobCounter;
+
+typedef struct jobDecl {
+    pfnJob fn;
+    void* data;
+} jobDecl;
+
+/**
+ * @brief Called with a range [start, end) of a jobParallelFor.
+ */
+typedef void (*pfnParallelFor)(u32 start, u32 end, void* userData);
+
+b8 jobSystemInit(u64* memoryReq, void* memory, jobSystemSettings settings);
+
+/**
+ * @brief Runs every job that's still queued, then stops and joins the
+ * workers. Shut down before anything jobs might use.
+ */
+void jobSystemShutdown();
+
+/**
+ * @brief Workers including the thread that called jobSystemInit.
+ */
+CT_API u32 jobSystemWorkerCount();
+
+/**
+ * @brief Queues fn(data).
+ * @param counter Increased now and decreased when the job is done, can be 0
+ */
+CT_API void jobRun(pfnJob fn, void* data, jobCounter* counter);
+
+/**
+ * @brief Queues count jobs that all report to counter.
+ */
+CT_API void jobRunMany(const jobDecl* jobs, u32 count, jobCounter* counter);
+
+/**
+ * @brief Runs jobs until counter is 0. With nothing left to run it sleeps
+ * until the last job finishes, other than on threads that aren't workers,
+ * which poll.
+ */
+CT_API void jobWait(jobCounter* counter);
+
+/**
+ * @brief Runs one queued job, for threads that wait on something other than
+ * a counter.
+ * @returns false if there was nothing to run
+ */
+CT_API b8 jobTryRun();
+
+/**
+ * @brief Calls fn over [0, count) in ranges of grain items, spread over the
+ * workers. The calling thread helps and it returns when all are done.
+ * @param grain Items per call, 0 picks one so every worker gets a few
+ */
+CT_API void jobParallelFor(u32 count, u32 grain, pfnParallelFor fn, void* userData);
+
+/**
+ * @brief jobParallelFor over every element of a dino array, userData is the
+ * array itself.
+ */
+#define jobParallelForDino(array, grain, fn)                                   \
+    jobParallelFor((u32)dinoLength(array), grain, fn, array)
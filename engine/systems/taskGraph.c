@@ -0,0 +1,314 @@
+#include "taskGraph.h"
+
+#include "core/fmemory.h"
+#include "core/fstring.h"
+#include "core/logger.h"
+#include "platform/platform.h"
+#include "systems/jobSystem.h"
+
+// Times taskGraphRun looks for something to do before going to sleep
+#define TASK_GRAPH_IDLE_SPINS 64
+
+b8 taskGraphCreate(taskGraph* outGraph) {
+    fzeroMemory(outGraph, sizeof(taskGraph));
+    if (!platformSemaphoreCreate(0, &outGraph->wake)) {
+        FERROR("Couldn't create the task graph's semaphore.");
+        return false;
+    }
+    return true;
+}
+
+void taskGraphDestroy(taskGraph* graph) {
+    platformSemaphoreDestroy(&graph->wake);
+    graph->compiled = false;
+    graph->nodeCount = 0;
+}
+
+b8 taskGraphAddNode(taskGraph* graph, const char* name, pfnTask fn, void* userData,
+                    taskFlags flags, u32* outId) {
+    if (graph->compiled || graph->nodeCount == TASK_GRAPH_MAX_NODES) {
+        FERROR("Couldn't add task %s, the graph is full or compiled.", name);
+        return false;
+    }
+    taskNode* node = &graph->nodes[graph->nodeCount];
+    node->name = name;
+    node->fn = fn;
+    node->userData = userData;
+    node->flags = flags;
+    node->graph = graph;
+    *outId = graph->nodeCount++;
+    return true;
+}
+
+b8 taskGraphAddDependency(taskGraph* graph, u32 before, u32 after) {
+    if (graph->compiled || before >= graph->nodeCount || after >= graph->nodeCount ||
+        before == after) {
+        FERROR("Invalid task dependency %u -> %u.", before, after);
+        return false;
+    }
+    taskNode* node = &graph->nodes[before];
+    for (u32 i = 0; i < node->successorCount; i++) {
+        if (node->successors[i] == after) {
+            return true;
+        }
+    }
+    if (node->successorCount == TASK_GRAPH_MAX_SUCCESSORS) {
+        FERROR("Task %s has too many successors.", node->name);
+        return false;
+    }
+    node->successors[node->successorCount++] = after;
+    graph->nodes[after].dependencyCount++;
+    return true;
+}
+
+b8 taskGraphCompile(taskGraph* graph) {
+    // Kahn's algorithm, whatever is left over is part of a cycle
+    u32 remaining[TASK_GRAPH_MAX_NODES];
+    u32 count = 0;
+    for (u32 i = 0; i < graph->nodeCount; i++) {
+        remaining[i] = graph->nodes[i].dependencyCount;
+        if (!remaining[i]) {
+            graph->order[count++] = i;
+        }
+    }
+    for (u32 i = 0; i < count; i++) {
+        taskNode* node = &graph->nodes[graph->order[i]];
+        for (u32 s = 0; s < node->successorCount; s++) {
+            if (--remaining[node->successors[s]] == 0) {
+                graph->order[count++] = node->successors[s];
+            }
+        }
+    }
+    if (count != graph->nodeCount) {
+        FERROR("Task graph has a cycle.");
+        return false;
+    }
+    graph->compiled = true;
+    return true;
+}
+
+static void schedule(taskGraph* graph, u32 id);
+
+// Pairs with the seq_cst store of parked in taskGraphRun, after a seq_cst
+// change to mainReady or done. Either the caller sees the change before it
+// sleeps or this sees it parked.
+static void wakeCaller(taskGraph* graph) {
+    if (atomic_exchange_explicit(&graph->parked, false, memory_order_seq_cst)) {
+        platformSemaphoreSignal(&graph->wake, 1);
+    }
+}
+
+static void runNode(taskNode* node) {
+    taskGraph* graph = node->graph;
+    node->startNs = platformGetAbsoluteTimeNs() - graph->runStartNs;
+    node->fn(node->userData);
+    node->endNs = platformGetAbsoluteTimeNs() - graph->runStartNs;
+
+    for (u32 i = 0; i < node->successorCount; i++) {
+        u32 id = node->successors[i];
+        // acq_rel so the last dependency to finish passes on what all of
+        // them wrote
+        if (atomic_fetch_sub_explicit(&graph->nodes[id].pending, 1, memory_order_acq_rel) == 1) {
+            schedule(graph, id);
+        }
+    }
+    if (atomic_fetch_add_explicit(&graph->done, 1, memory_order_seq_cst) + 1 == graph->nodeCount) {
+        wakeCaller(graph);
+    }
+}
+
+static void taskJob(void* data) {
+    runNode(data);
+}
+
+static void schedule(taskGraph* graph, u32 id) {
+    if (graph->nodes[id].flags & TASK_FLAG_MAIN_THREAD) {
+        atomic_fetch_or_explicit(&graph->mainReady, 1u << id, memory_order_seq_cst);
+        wakeCaller(graph);
+    } else {
+        jobRun(taskJob, &graph->nodes[id], 0);
+    }
+}
+
+// Longest chain through the graph by this run's node times
+static void findCriticalPath(taskGraph* graph, taskGraphFrameStats* stats) {
+    u64 length[TASK_GRAPH_MAX_NODES];
+    u32 prev[TASK_GRAPH_MAX_NODES];
+    for (u32 i = 0; i < graph->nodeCount; i++) {
+        length[i] = graph->nodes[i].endNs - graph->nodes[i].startNs;
+        prev[i] = INVALID_ID;
+    }
+
+    u32 last = graph->order[0];
+    for (u32 i = 0; i < graph->nodeCount; i++) {
+        u32 id = graph->order[i];
+        taskNode* node = &graph->nodes[id];
+        for (u32 s = 0; s < node->successorCount; s++) {
+            u32 next = node->successors[s];
+            u64 through = length[id] + graph->nodes[next].endNs - graph->nodes[next].startNs;
+            if (through > length[next]) {
+                length[next] = through;
+                prev[next] = id;
+            }
+        }
+        if (length[id] > length[last]) {
+            last = id;
+        }
+    }
+
+    stats->criticalMs = (f32)(length[last] / 1000000.0);
+    u32 count = 0;
+    for (u32 id = last; id != INVALID_ID; id = prev[id]) {
+        stats->criticalPath[count++] = id;
+    }
+    // Walked back from the end, turn it around
+    for (u32 i = 0; i < count / 2; i++) {
+        u32 tmp = stats->criticalPath[i];
+        stats->criticalPath[i] = stats->criticalPath[count - 1 - i];
+        stats->criticalPath[count - 1 - i] = tmp;
+    }
+    stats->criticalPathLength = count;
+}
+
+static void collectStats(taskGraph* graph) {
+    taskGraphFrameStats* stats = &graph->last;
+    u64 end = 0;
+    u64 busy = 0;
+    for (u32 i = 0; i < graph->nodeCount; i++) {
+        taskNode* node = &graph->nodes[i];
+        u64 took = node->endNs - node->startNs;
+        busy += took;
+        node->totalMs += took / 1000000.0;
+        end = node->endNs > end ? node->endNs : end;
+    }
+    stats->wallMs = (f32)(end / 1000000.0);
+    stats->busyMs = (f32)(busy / 1000000.0);
+    findCriticalPath(graph, stats);
+    for (u32 i = 0; i < stats->criticalPathLength; i++) {
+        graph->nodes[stats->criticalPath[i]].criticalCount++;
+    }
+
+    graph->totalRuns++;
+    graph->runs++;
+    graph->wallSum += stats->wallMs;
+    graph->criticalSum += stats->criticalMs;
+    graph->busySum += stats->busyMs;
+}
+
+void taskGraphRun(taskGraph* graph) {
+    if (!graph->compiled || !graph->nodeCount) {
+        return;
+    }
+    u64 now = platformGetAbsoluteTimeNs();
+    if (!graph->lastLog) {
+        graph->lastLog = now;
+    }
+    graph->runStartNs = now;
+    atomic_store_explicit(&graph->mainReady, 0, memory_order_relaxed);
+    atomic_store_explicit(&graph->done, 0, memory_order_relaxed);
+    for (u32 i = 0; i < graph->nodeCount; i++) {
+        atomic_store_explicit(&graph->nodes[i].pending, graph->nodes[i].dependencyCount,
+                              memory_order_relaxed);
+    }
+    for (u32 i = 0; i < graph->nodeCount; i++) {
+        if (!graph->nodes[i].dependencyCount) {
+            schedule(graph, i);
+        }
+    }
+
+    u32 idle = 0;
+    while (atomic_load_explicit(&graph->done, memory_order_acquire) < graph->nodeCount) {
+        u32 ready = atomic_exchange_explicit(&graph->mainReady, 0, memory_order_acquire);
+        if (ready) {
+            for (u32 i = 0; i < graph->nodeCount; i++) {
+                if (ready & (1u << i)) {
+                    runNode(&graph->nodes[i]);
+                }
+            }
+            idle = 0;
+            continue;
+        }
+        if (jobTryRun()) {
+            idle = 0;
+            continue;
+        }
+        if (++idle < TASK_GRAPH_IDLE_SPINS) {
+            FSN_CPU_RELAX();
+            continue;
+        }
+
+        // Whatever is left is running on the workers, e.g. a node stuck in
+        // a fence wait. Sleep until a main thread node is ready or the last
+        // node is done.
+        idle = 0;
+        atomic_store_explicit(&graph->parked, true, memory_order_seq_cst);
+        if (atomic_load_explicit(&graph->mainReady, memory_order_seq_cst) ||
+            atomic_load_explicit(&graph->done, memory_order_seq_cst) == graph->nodeCount) {
+            // A node that saw parked set has signalled, or is about to
+            if (!atomic_exchange_explicit(&graph->parked, false, memory_order_seq_cst)) {
+                platformSemaphoreWait(&graph->wake, PLATFORM_WAIT_INFINITE);
+            }
+            continue;
+        }
+        platformSemaphoreWait(&graph->wake, PLATFORM_WAIT_INFINITE);
+    }
+
+    collectStats(graph);
+    if (TASK_GRAPH_LOG_INTERVAL > 0 &&
+        now - graph->lastLog >= (u64)(TASK_GRAPH_LOG_INTERVAL * 1000000000.0)) {
+        taskGraphLogSummary(graph);
+        graph->lastLog = now;
+    }
+}
+
+b8 taskGraphGetFrameStats(taskGraph* graph, taskGraphFrameStats* outStats) {
+    if (!graph->totalRuns) {
+        fzeroMemory(outStats, sizeof(taskGraphFrameStats));
+        return false;
+    }
+    *outStats = graph->last;
+    return true;
+}
+
+void taskGraphLogSummary(taskGraph* graph) {
+    if (!graph->runs) {
+        return;
+    }
+    f64 runs = graph->runs;
+    f64 wall = graph->wallSum / runs;
+    FINFO("Task graph over %u runs (ms): wall %.3f, critical path %.3f, busy %.3f, "
+          "%.2fx parallel",
+          graph->runs, wall, graph->criticalSum / runs, graph->busySum / runs,
+          wall > 0 ? graph->busySum / graph->wallSum : 0.0);
+    for (u32 i = 0; i < graph->nodeCount; i++) {
+        taskNode* node = &graph->nodes[i];
+        FINFO("  %-12s %.3f ms, critical in %3.0f%% of runs", node->name, node->totalMs / runs,
+              node->criticalCount * 100.0 / runs);
+        node->totalMs = 0;
+        node->criticalCount = 0;
+    }
+
+    char path[256];
+    u32 used = 0;
+    path[0] = 0;
+    for (u32 i = 0; i < graph->last.criticalPathLength; i++) {
+        const char* name = graph->nodes[graph->last.criticalPath[i]].name;
+        u32 len = (u32)strLen(name);
+        if (used + len + 4 >= sizeof(path)) {
+            break;
+        }
+        if (i) {
+            fcopyMemory(path + used, " > ", 3);
+            used += 3;
+        }
+        fcopyMemory(path + used, name, len);
+        used += len;
+        path[used] = 0;
+    }
+    FINFO("  last critical path: %s", path);
+
+    graph->runs = 0;
+    graph->wallSum = 0;
+    graph->criticalSum = 0;
+    graph->busySum = 0;
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "defines.h"
+#include "platform/platform.h"
+
+#include <stdatomic.h>
+
+/**
+ *  A fixed graph of tasks run once per frame on the job system. Nodes are
+ * added with what they depend on, taskGraphCompile checks the graph once and
+ * every taskGraphRun after that starts each node as soon as the ones before
+ * it are done, so nodes that don't depend on each other overlap.
+ *
+ *  Every run times its nodes and works out the critical path, the longest
+ * chain of dependent nodes by how long they really took. That's the frame
+ * time no amount of extra workers gets under.
+ */
+
+#define TASK_GRAPH_MAX_NODES 32
+#define TASK_GRAPH_MAX_SUCCESSORS 8
+// Seconds between the summaries logged from taskGraphRun. 0 turns them off.
+#ifndef TASK_GRAPH_LOG_INTERVAL
+#define TASK_GRAPH_LOG_INTERVAL 10.0
+#endif
+
+typedef void (*pfnTask)(void* userData);
+
+typedef enum taskFlags {
+    TASK_FLAG_NONE = 0,
+    // Runs on the thread that calls taskGraphRun, e.g. for the OS message
+    // pump
+    TASK_FLAG_MAIN_THREAD = 1 << 0
+} taskFlags;
+
+typedef struct taskNode {
+    const char* name;
+    pfnTask fn;
+    void* userData;
+    taskFlags flags;
+    struct taskGraph* graph;
+
+    u32 dependencyCount;
+    u32 successorCount;
+    u32 successors[TASK_GRAPH_MAX_SUCCESSORS];
+
+    // This run's dependencies still to finish
+    _Atomic u32 pending;
+    // Relative to the start of the run
+    u64 startNs;
+    u64 endNs;
+
+    // Since the last summary
+    f64 totalMs;
+    u32 criticalCount;
+} taskNode;
+
+/** @brief Timings of a single run in milliseconds. */
+typedef struct taskGraphFrameStats {
+    /** @brief From taskGraphRun being called to the last node finishing. */
+    f32 wallMs;
+    /** @brief The longest chain of dependent nodes. */
+    f32 criticalMs;
+    /** @brief All the nodes' times added up. */
+    f32 busyMs;
+    /** @brief Node ids along the critical path, first to last. */
+    u32 criticalPath[TASK_GRAPH_MAX_NODES];
+    u32 criticalPathLength;
+} taskGraphFrameStats;
+
+typedef struct taskGraph {
+    taskNode nodes[TASK_GRAPH_MAX_NODES];
+    u32 nodeCount;
+    // Topological order, set by taskGraphCompile
+    u32 order[TASK_GRAPH_MAX_NODES];
+    b8 compiled;
+
+    // Bits of main thread nodes that are ready to run
+    _Atomic u32 mainReady;
+    _Atomic u32 done;
+    u64 runStartNs;
+    // The thread in taskGraphRun sleeps on wake when there's nothing for it
+    // to do, parked is set while it does
+    _Atomic b8 parked;
+    platformSemaphore wake;
+
+    taskGraphFrameStats last;
+    u64 totalRuns;
+    // Since the last summary
+    u32 runs;
+    f64 wallSum;
+    f64 criticalSum;
+    f64 busySum;
+    u64 lastLog;
+} taskGraph;
+
+/**
+ * @returns false if the graph's semaphore couldn't be created
+ */
+CT_API b8 taskGraphCreate(taskGraph* outGraph);
+
+CT_API void taskGraphDestroy(taskGraph* graph);
+
+/**
+ * @brief Adds a node, only before taskGraphCompile.
+ * @param name Kept as is, has to outlive the graph
+ * @param outId Id to refer to the node by
+ * @returns false if the graph is full or already compiled
+ */
+CT_API b8 taskGraphAddNode(taskGraph* graph, const char* name, pfnTask fn, void* userData,
+                           taskFlags flags, u32* outId);
+
+/**
+ * @brief Makes after wait for before, only before taskGraphCompile.
+ * @returns false if either id is wrong or before has too many successors
+ */
+CT_API b8 taskGraphAddDependency(taskGraph* graph, u32 before, u32 after);
+
+/**
+ * @brief Checks the graph has no cycles and works out the order to report
+ * it in. Nothing can be added afterwards.
+ * @returns false if there's a cycle
+ */
+CT_API b8 taskGraphCompile(taskGraph* graph);
+
+/**
+ * @brief Runs every node once and returns when all are done. The calling
+ * thread runs the main thread nodes and helps with the rest, and sleeps
+ * while there's neither.
+ */
+CT_API void taskGraphRun(taskGraph* graph);
+
+/**
+ * @brief Timings of the last run.
+ * @returns false if it hasn't run yet
+ */
+CT_API b8 taskGraphGetFrameStats(taskGraph* graph, taskGraphFrameStats* outStats);
+
+/**
+ * @brief Logs the averages since the last summary and the last critical
+ * path, then starts over.
+ */
+CT_API void taskGraphLogSummary(taskGraph* graph);
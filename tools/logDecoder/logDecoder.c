@@ -0,0 +1,332 @@
+/**
+ * Turns a binary log (appLogger.blog, see engine/core/logBinary.h) back into
+ * text. Messages are sorted by time since chunks from different threads are
+ * written in whatever order they fill up.
+ *
+ * Usage: logDecoder <input.blog> [output.log]
+ */
+#include "core/logBinary.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct site {
+    b8 known;
+    u8 level;
+    u32 line;
+    u8 argCnt;
+    u8 argKinds[LOG_BINARY_MAX_ARGS];
+    char* format;
+    char* file;
+} site;
+
+typedef struct message {
+    f64 time;
+    u64 order;
+    // Start of the record's argument bytes
+    const u8* args;
+    u32 siteId;
+} message;
+
+static const char* levelStr[6] = {"[FATAL]: ", "[ERROR]: ", "[WARN]:  ",
+                                  "[INFO]:  ", "[DEBUG]: ", "[TRACE]: "};
+
+static site sites[LOG_BINARY_MAX_SITES];
+
+static u8* readFile(const char* path, u64* outSize) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return 0;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    u8* data = malloc(size > 0 ? size : 1);
+    *outSize = fread(data, 1, size, f);
+    fclose(f);
+    return data;
+}
+
+static char* dupBytes(const u8* p, u16 len) {
+    char* s = malloc(len + 1);
+    memcpy(s, p, len);
+    s[len] = 0;
+    return s;
+}
+
+// Size of a message record's arguments, or 0 if it runs past end
+static u64 argsSize(const site* s, const u8* p, const u8* end) {
+    const u8* start = p;
+    for (u8 i = 0; i < s->argCnt; i++) {
+        if (s->argKinds[i] == LOG_BINARY_ARG_STR) {
+            if (end - p < 2) {
+                return 0;
+            }
+            u16 len;
+            memcpy(&len, p, 2);
+            p += 2 + len;
+        } else {
+            p += 8;
+        }
+        if (p > end) {
+            return 0;
+        }
+    }
+    return p - start;
+}
+
+// Prints one message by handing printf each conversion with its own argument
+static void printMessage(FILE* out, const site* s, const u8* args) {
+    const char* f = s->format;
+    u8 argIdx = 0;
+    while (*f) {
+        if (*f != '%') {
+            fputc(*f++, out);
+            continue;
+        }
+        if (f[1] == '%') {
+            fputc('%', out);
+            f += 2;
+            continue;
+        }
+
+        // Copy the conversion spec, replacing '*' with the stored value
+        char spec[64];
+        u32 len = 0;
+        spec[len++] = *f++;
+        while (*f && !strchr("diuoxXcfFeEgGaAsp", *f)) {
+            if (*f == '*') {
+                i64 v;
+                memcpy(&v, args, 8);
+                args += 8;
+                argIdx++;
+                len += snprintf(spec + len, sizeof(spec) - len, "%d", (int)v);
+            } else if (len < sizeof(spec) - 2) {
+                spec[len++] = *f;
+            }
+            f++;
+        }
+        if (!*f || argIdx >= s->argCnt) {
+            break;
+        }
+        spec[len++] = *f++;
+        spec[len] = 0;
+
+        u64 raw = 0;
+        if (s->argKinds[argIdx] != LOG_BINARY_ARG_STR) {
+            memcpy(&raw, args, 8);
+            args += 8;
+        }
+        switch (s->argKinds[argIdx++]) {
+        case LOG_BINARY_ARG_INT:
+            fprintf(out, spec, (int)raw);
+            break;
+        case LOG_BINARY_ARG_LONG:
+            fprintf(out, spec, (long)raw);
+            break;
+        case LOG_BINARY_ARG_LONG_LONG:
+            fprintf(out, spec, (long long)raw);
+            break;
+        case LOG_BINARY_ARG_SIZE:
+            fprintf(out, spec, (size_t)raw);
+            break;
+        case LOG_BINARY_ARG_INTMAX:
+            fprintf(out, spec, (intmax_t)raw);
+            break;
+        case LOG_BINARY_ARG_PTRDIFF:
+            fprintf(out, spec, (ptrdiff_t)raw);
+            break;
+        case LOG_BINARY_ARG_DOUBLE: {
+            double d;
+            memcpy(&d, &raw, 8);
+            fprintf(out, spec, d);
+            break;
+        }
+        case LOG_BINARY_ARG_PTR:
+            fprintf(out, spec, (void*)(uintptr_t)raw);
+            break;
+        case LOG_BINARY_ARG_STR: {
+            u16 strLen;
+            memcpy(&strLen, args, 2);
+            char* str = dupBytes(args + 2, strLen);
+            args += 2 + strLen;
+            fprintf(out, spec, str);
+            free(str);
+            break;
+        }
+        }
+    }
+    fputc('\n', out);
+}
+
+typedef struct messageList {
+    message* items;
+    u64 cnt;
+    u64 capacity;
+    u64 skipped;
+} messageList;
+
+/*
+ * Walks every chunk. Without msgs it only picks up site descriptions and
+ * returns how many new ones it found. A chunk is abandoned at the first
+ * message whose site isn't known yet, since the record size depends on it.
+ * With msgs it collects every message instead.
+ */
+static u32 scanChunks(const u8* data, u64 size, messageList* msgs) {
+    u32 newSites = 0;
+    const u8* p = data + sizeof(logBinaryFileHeader);
+    const u8* fileEnd = data + size;
+    while (fileEnd - p >= 8) {
+        u32 chunk[2];
+        memcpy(chunk, p, 8);
+        if (chunk[0] != LOG_BINARY_CHUNK_MAGIC ||
+            chunk[1] > (u64)(fileEnd - p - 8)) {
+            // Cut off by a crash, everything before it is still good
+            if (msgs) {
+                fprintf(stderr, "Truncated chunk at offset %llu\n",
+                        (unsigned long long)(p - data));
+            }
+            break;
+        }
+        p += 8;
+        const u8* end = p + chunk[1];
+        while (end - p >= 5) {
+            u8 type = *p++;
+            u32 id;
+            memcpy(&id, p, 4);
+            p += 4;
+            if (id >= LOG_BINARY_MAX_SITES) {
+                break;
+            }
+
+            if (type == LOG_BINARY_RECORD_SITE) {
+                site* s = &sites[id];
+                u8 level = *p++;
+                u32 line;
+                memcpy(&line, p, 4);
+                p += 4;
+                u8 argCnt = *p++;
+                const u8* kinds = p;
+                p += argCnt;
+                u16 fmtLen, fileLen;
+                memcpy(&fmtLen, p, 2);
+                const u8* fmt = p + 2;
+                p += 2 + fmtLen;
+                memcpy(&fileLen, p, 2);
+                const u8* file = p + 2;
+                p += 2 + fileLen;
+                if (p > end) {
+                    break;
+                }
+                if (!s->known && argCnt <= LOG_BINARY_MAX_ARGS) {
+                    s->known = true;
+                    s->level = level;
+                    s->line = line;
+                    s->argCnt = argCnt;
+                    memcpy(s->argKinds, kinds, argCnt);
+                    s->format = dupBytes(fmt, fmtLen);
+                    s->file = dupBytes(file, fileLen);
+                    newSites++;
+                }
+            } else if (type == LOG_BINARY_RECORD_MESSAGE) {
+                const site* s = &sites[id];
+                if (!s->known) {
+                    if (msgs) {
+                        msgs->skipped++;
+                    }
+                    break;
+                }
+                f64 time;
+                memcpy(&time, p, 8);
+                p += 8;
+                u64 argBytes = argsSize(s, p, end);
+                if (p > end || (s->argCnt && !argBytes)) {
+                    break;
+                }
+                if (msgs) {
+                    if (msgs->cnt == msgs->capacity) {
+                        msgs->capacity = msgs->capacity ? msgs->capacity * 2 : 1024;
+                        msgs->items = realloc(msgs->items,
+                                              sizeof(message) * msgs->capacity);
+                    }
+                    msgs->items[msgs->cnt] = (message){time, msgs->cnt, p, id};
+                    msgs->cnt++;
+                }
+                p += argBytes;
+            } else {
+                break;
+            }
+        }
+        p = end;
+    }
+    return newSites;
+}
+
+static int compareMessages(const void* a, const void* b) {
+    const message* m0 = a;
+    const message* m1 = b;
+    if (m0->time != m1->time) {
+        return m0->time < m1->time ? -1 : 1;
+    }
+    return m0->order < m1->order ? -1 : (m0->order > m1->order);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <input.blog> [output.log]\n", argv[0]);
+        return 1;
+    }
+
+    u64 size = 0;
+    u8* data = readFile(argv[1], &size);
+    if (!data) {
+        fprintf(stderr, "Couldn't read %s\n", argv[1]);
+        return 1;
+    }
+    logBinaryFileHeader header;
+    if (size < sizeof(header) ||
+        (memcpy(&header, data, sizeof(header)),
+         memcmp(header.magic, LOG_BINARY_MAGIC, 8) != 0)) {
+        fprintf(stderr, "%s is not a binary log\n", argv[1]);
+        return 1;
+    }
+    if (header.version != LOG_BINARY_VERSION) {
+        fprintf(stderr, "Unsupported binary log version %u\n", header.version);
+        return 1;
+    }
+
+    FILE* out = stdout;
+    if (argc > 2 && !(out = fopen(argv[2], "w"))) {
+        fprintf(stderr, "Couldn't open %s\n", argv[2]);
+        return 1;
+    }
+
+    // Keep reading the site descriptions until no new ones show up (a chunk
+    // can use a site that is described in a later chunk), then decode.
+    messageList msgs = {0};
+    while (scanChunks(data, size, 0)) {
+    }
+    scanChunks(data, size, &msgs);
+
+    qsort(msgs.items, msgs.cnt, sizeof(message), compareMessages);
+    for (u64 i = 0; i < msgs.cnt; i++) {
+        const site* s = &sites[msgs.items[i].siteId];
+        fprintf(out, "[%.6f] %s", msgs.items[i].time,
+                levelStr[s->level < 6 ? s->level : 5]);
+        printMessage(out, s, msgs.items[i].args);
+    }
+    if (msgs.skipped) {
+        fprintf(stderr, "Skipped %llu messages with unknown call sites\n",
+                (unsigned long long)msgs.skipped);
+    }
+
+    if (out != stdout) {
+        fclose(out);
+    }
+    free(msgs.items);
+    free(data);
+    return 0;
+}